@@ -117,44 +117,67 @@ int ** GameOfLife::lattice()
   return lattices[latticeIndex];
 }
 
-void GameOfLife::run()
+bool GameOfLife::step()
 {
-  
-  int **fp, **fr;
-  while ( true )
+  SAMU_PHASE ( TICK );
+
+  int ** reality = lattices[latticeIndex];
+
+  // the end of the source is not a tick
+  if ( m_source )
     {
-      QThread::msleep ( m_delay );
+      SAMU_PHASE ( DEVELOPMENT );
 
-      if ( !paused )
+      if ( !m_source->next() && ! ( m_source->rewind() && m_source->next() ) )
         {
+          return false;
+        }
 
-          ++m_time;
+      reality = m_source->lattice();
+    }
 
-          qDebug() << "<<<" << m_time << "<<<";
+  ++m_time;
 
-          development();
+  SamuLog::log ( SamuEvent::TICK_BEGIN, m_time );
 
-          if ( samuBrain )
-            {
-              samuBrain->learning ( lattices[latticeIndex], predictions, &fp, &fr );
-              qDebug() << m_time
-                       << "   #MPUs:" << samuBrain->nofMPUs()
-                       << "Observation (MPU):" << samuBrain->get_foobar().c_str();
-            }
+  // the reality of this tick has been generated in the previous one
+  bool learning = m_learning;
 
-          latticeIndex = ( latticeIndex+1 ) %2;
-          emit cellsChanged ( lattices[latticeIndex], predictions, fp, fr );
+  if ( m_source )
+    {
+      m_time = m_source->tick();
+    }
+  else if ( m_timeline )
+    {
+      SAMU_PHASE ( DEVELOPMENT );
+      m_learning = development_timeline();
+    }
+  else
+    {
+      SAMU_PHASE ( DEVELOPMENT );
+      development();
+    }
 
-          qDebug() << ">>>" << m_time << ">>>";
+  if ( m_recorder && learning )
+    {
+      m_recorder->write ( reality, m_time );
+    }
 
+  if ( samuBrain && learning )
+    {
+      samuBrain->learning ( reality, predictions, &m_fp, &m_fr );
+      if ( SamuLog::enabled ( SamuEvent::OBSERVATION ) )
+        {
+          SamuLog::log ( SamuEvent::OBSERVATION, m_time, samuBrain->get_foobar(), 0.0, samuBrain->nofMPUs() );
         }
+      SamuTrace::counter ( SamuCounter::MPUS, m_time, samuBrain->nofMPUs() );
     }
 
-}
+  latticeIndex = ( latticeIndex+1 ) %2;
 
-void GameOfLife::pause()
-{
-  paused = !paused;
+  SamuLog::log ( SamuEvent::TICK_END, m_time );
+
+  return true;
 }
 
 int GameOfLife::numberOfNeighbors ( int **lattice, int r, int c, int state )
@@ -253,7 +276,8 @@ void GameOfLife::control_Movie ( int **nextLattice )
   if ( m_time %3 ==0 )
     {
 
-      if ( carx < m_w-5 )
+      // the car is 5 cells wide
+      if ( carx < m_w-6 )
         {
           carx += 2;
         }
@@ -275,54 +299,34 @@ void GameOfLife::control_Movie ( int **nextLattice )
         }
     }
 
-  house ( nextLattice, housex, 3*m_h/5 -6 );
-  car ( nextLattice, carx, 3*m_h/5 +1 );
-  man ( nextLattice, manx, 3*m_h/5-1 );
+  blit ( nextLattice, SamuSpriteId::HOUSE, housex, 3*m_h/5 -6 );
+  blit ( nextLattice, SamuSpriteId::CAR, carx, 3*m_h/5 +1 );
+  blit ( nextLattice, SamuSpriteId::MAN, manx, 3*m_h/5-1 );
 
 }
 
 void GameOfLife::control_Stroop ( int **nextLattice )
 {
-  if ( ++age <20 )
-    {
-      red ( nextLattice, 2, 5, 1 );
-    }
-  else if ( age <40 )
-    {
-      green ( nextLattice, 2, 5, 1 );
-    }
-  else if ( age <60 )
-    {
-      blue ( nextLattice, 2, 5, 1 );
-    }
-  else if ( age <80 )
-    {
-      red ( nextLattice, 2, 5, 2 );
-    }
-  else if ( age <100 )
-    {
-      green ( nextLattice, 2, 5, 2 );
-    }
-  else if ( age <120 )
-    {
-      blue ( nextLattice, 2, 5, 2 );
-    }
-  else if ( age <140 )
-    {
-      red ( nextLattice, 2, 5, 3 );
-    }
-  else if ( age <160 )
-    {
-      green ( nextLattice, 2, 5, 3 );
-    }
-  else if ( age <180 )
+  // the words and their colors, each one for 20 ticks
+  static const struct
+  {
+    SamuSpriteId word;
+    int color;
+  } stroop[] =
+  {
+    {SamuSpriteId::RED, 1}, {SamuSpriteId::GREEN, 1}, {SamuSpriteId::BLUE, 1},
+    {SamuSpriteId::RED, 2}, {SamuSpriteId::GREEN, 2}, {SamuSpriteId::BLUE, 2},
+    {SamuSpriteId::RED, 3}, {SamuSpriteId::GREEN, 3}, {SamuSpriteId::BLUE, 3}
+  };
+
+  if ( ++age < 180 )
     {
-      blue ( nextLattice, 2, 5, 3 );
+      blit ( nextLattice, stroop[age/20].word, 2, 5, stroop[age/20].color );
     }
   else
     {
       age =0;
-      red ( nextLattice, 2, 5, 2 );
+      blit ( nextLattice, SamuSpriteId::RED, 2, 5, 2 );
     }
 
 }
@@ -339,22 +343,17 @@ void GameOfLife::development()
     {
       //clear_lattice ( nextLattice );
 
-      glider ( nextLattice, 2*m_w/5, 2*m_h/5 );
-      glider ( nextLattice, 3*m_w/5, 3*m_h/5 );
-      glider ( nextLattice, 4*m_w/5, 4*m_h/5 );
-      glider ( nextLattice, 4*m_w/5, 2*m_h/5 );
-      glider ( nextLattice, 2*m_w/5, 4*m_h/5 );
-
+      gliders ( nextLattice );
     }
-  else if ( m_time < 5000 )
+  else if ( m_time < m_conway )
     {
       control_Conway ( prevLattice, nextLattice );
     }
-  else if ( m_time < 13000 )
+  else if ( m_time < m_stroop )
     {
       control_Stroop ( nextLattice );
     }
-  else if ( m_time < 22000 )
+  else if ( m_time < m_movie )
     {
       control_Movie ( nextLattice );
     }
@@ -365,167 +364,57 @@ void GameOfLife::development()
 
 }
 
-void GameOfLife::red ( int **lattice, int x, int y, int color )
-{
-
-  int r[7][17] =
-  {
-    {1,1,1,0,0,0,1,1,1,1,1,0,1,1,1,0,0},
-    {1,0,0,1,0,0,1,0,0,0,0,0,1,0,0,1,0},
-    {1,0,0,1,0,0,1,0,0,0,0,0,1,0,0,0,1},
-    {1,1,1,0,0,0,1,1,1,1,0,0,1,0,0,0,1},
-    {1,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,1},
-    {1,0,0,1,0,0,1,0,0,0,0,0,1,0,0,1,0},
-    {1,0,0,0,1,0,1,1,1,1,1,0,1,1,1,0,0}
-  };
-
-  for ( int i {0}; i<7; ++i )
-    {
-      for ( int j {0}; j<17; ++j )
-        {
-          if ( r[i][j] )
-            {
-              lattice[y+i][x+j] = r[i][j]*color;
-            }
-        }
-
-    }
-}
-
-void GameOfLife::green ( int **lattice, int x, int y, int color )
+bool GameOfLife::development_timeline()
 {
+  const std::vector<SamuSegment> & segments = m_timeline->segments();
 
-  int r[7][29] =
-  {
-    {0,1,1,1,0,0,1,1,1,0,0,0,1,1,1,1,1,0,1,1,1,1,1,0,1,0,0,0,1},
-    {1,0,0,0,1,0,1,0,0,1,0,0,1,0,0,0,0,0,1,0,0,0,0,0,1,1,0,0,1},
-    {1,0,0,0,0,0,1,0,0,1,0,0,1,0,0,0,0,0,1,0,0,0,0,0,1,1,1,0,1},
-    {1,0,1,1,1,0,1,1,1,0,0,0,1,1,1,1,0,0,1,1,1,1,0,0,1,0,1,0,1},
-    {1,0,0,0,1,0,1,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,1,0,1,1,1},
-    {1,0,0,0,1,0,1,0,0,1,0,0,1,0,0,0,0,0,1,0,0,0,0,0,1,0,0,1,1},
-    {0,1,1,1,0,0,1,0,0,0,1,0,1,1,1,1,1,0,1,1,1,1,1,0,1,0,0,0,1}
-  };
-
-  for ( int i {0}; i<7; ++i )
+  if ( m_elapsed == segments[m_segment].duration )
     {
-      for ( int j {0}; j<29; ++j )
-        {
-
-          if ( r[i][j] )
-            {
-              lattice[y+i][x+j] = r[i][j]*color;
-            }
-        }
-
+      m_segment = ( m_segment+1 ) % segments.size();
+      m_elapsed = 0;
     }
-}
 
-void GameOfLife::blue ( int **lattice, int x, int y, int color )
-{
+  const SamuSegment & segment = segments[m_segment];
+  ++m_elapsed;
 
-  int r[7][21] =
-  {
-    {1,1,1,0,0,1,0,0,0,0,1,0,0,0,1,0,1,1,1,1,1},
-    {1,0,0,1,0,1,0,0,0,0,1,0,0,0,1,0,1,0,0,0,0},
-    {1,0,0,1,0,1,0,0,0,0,1,0,0,0,1,0,1,0,0,0,0},
-    {1,1,1,0,0,1,0,0,0,0,1,0,0,0,1,0,1,1,1,1,0},
-    {1,0,0,1,0,1,0,0,0,0,1,0,0,0,1,0,1,0,0,0,0},
-    {1,0,0,1,0,1,0,0,0,0,1,0,0,0,1,0,1,0,0,0,0},
-    {1,1,1,0,0,1,1,1,1,0,0,1,1,1,0,0,1,1,1,1,1}
+  int **prevLattice = lattices[latticeIndex];
+  int **nextLattice = lattices[ ( latticeIndex+1 ) %2];
 
-  };
+  clear_lattice ( nextLattice );
 
-  for ( int i {0}; i<7; ++i )
+  switch ( segment.generator )
     {
-      for ( int j {0}; j<21; ++j )
-        {
-          if ( r[i][j] )
-            {
-              lattice[y+i][x+j] = r[i][j]*color;
-            }
-        }
-
+    case SamuGenerator::EMPTY:
+      break;
+    case SamuGenerator::GLIDERS:
+      gliders ( nextLattice );
+      break;
+    case SamuGenerator::CONWAY:
+      control_Conway ( prevLattice, nextLattice );
+      break;
+    case SamuGenerator::STROOP:
+      control_Stroop ( nextLattice );
+      break;
+    case SamuGenerator::MOVIE:
+      control_Movie ( nextLattice );
+      break;
     }
-}
-
-void GameOfLife::glider ( int **lattice, int x, int y )
-{
-
-  lattice[y+0][x+2] = 1;
-  lattice[y+1][x+1] = 1;
-  lattice[y+2][x+1] = 1;
-  lattice[y+2][x+2] = 1;
-  lattice[y+2][x+3] = 1;
-
-}
-
-void GameOfLife::house ( int **lattice, int x, int y )
-{
-
-  lattice[y+0][x+3] = 1;
-
-  lattice[y+1][x+2] = 1;
-  lattice[y+1][x+4] = 1;
-
-  lattice[y+2][x+1] = 1;
-  lattice[y+2][x+5] = 1;
-
-  lattice[y+3][x+0] = 1;
-  lattice[y+3][x+6] = 1;
 
-  lattice[y+4][x+0] = 1;
-  lattice[y+4][x+6] = 1;
-
-  lattice[y+5][x+0] = 1;
-  lattice[y+5][x+6] = 1;
-
-  lattice[y+6][x+0] = 1;
-  lattice[y+6][x+6] = 1;
-
-  lattice[y+7][x+0] = 1;
-  lattice[y+7][x+6] = 1;
-
-  lattice[y+8][x+0] = 1;
-  lattice[y+8][x+1] = 1;
-  lattice[y+8][x+2] = 1;
-  lattice[y+8][x+3] = 1;
-  lattice[y+8][x+4] = 1;
-  lattice[y+8][x+5] = 1;
-  lattice[y+8][x+6] = 1;
+  return segment.learning;
 }
 
-void GameOfLife::man ( int **lattice, int x, int y )
+void GameOfLife::gliders ( int **lattice )
 {
-
-  lattice[y+0][x+1] = 1;
-
-  lattice[y+1][x+0] = 1;
-  lattice[y+1][x+1] = 1;
-  lattice[y+1][x+2] = 1;
-
-  lattice[y+2][x+1] = 1;
-
-  lattice[y+3][x+0] = 1;
-  lattice[y+3][x+2] = 1;
-
+  blit ( lattice, SamuSpriteId::GLIDER, 2*m_w/5, 2*m_h/5 );
+  blit ( lattice, SamuSpriteId::GLIDER, 3*m_w/5, 3*m_h/5 );
+  blit ( lattice, SamuSpriteId::GLIDER, 4*m_w/5, 4*m_h/5 );
+  blit ( lattice, SamuSpriteId::GLIDER, 4*m_w/5, 2*m_h/5 );
+  blit ( lattice, SamuSpriteId::GLIDER, 2*m_w/5, 4*m_h/5 );
 }
 
-void GameOfLife::car ( int **lattice, int x, int y )
+void GameOfLife::blit ( int **lattice, SamuSpriteId id, int x, int y, int color )
 {
-
-  lattice[y+0][x+1] = 1;
-  lattice[y+0][x+2] = 1;
-  lattice[y+0][x+3] = 1;
-
-  lattice[y+1][x+0] = 1;
-  lattice[y+1][x+1] = 1;
-  lattice[y+1][x+2] = 1;
-  lattice[y+1][x+3] = 1;
-  lattice[y+1][x+4] = 1;
-
-  lattice[y+2][x+1] = 1;
-  lattice[y+2][x+3] = 1;
-
+  samu_sprite ( id ).blit ( lattice, m_w, m_h, x, y, color );
 }
 
 int GameOfLife::getW() const
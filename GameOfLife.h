@@ -52,15 +52,14 @@
  */
 
 
-#include <QThread>
-#include <QDebug>
 #include <sstream>
 #include "SamuBrain.h"
+#include "SamuFrames.h"
+#include "SamuTimeline.h"
+#include "SamuSprite.h"
 
-class GameOfLife : public QThread
+class GameOfLife
 {
-    Q_OBJECT
-
     int m_w {40}, m_h {30};
 
     int ***lattices;
@@ -70,27 +69,40 @@ class GameOfLife : public QThread
     SamuBrain* samuBrain;
 
     long m_time {0};
-    int m_delay {1};//{15};
     long age {0};
 
-    bool paused {false};
+    // the ends of the Conway, Stroop and Movie scenarios
+    long m_conway {5000};
+    long m_stroop {13000};
+    long m_movie {22000};
+
+    int **m_fp {nullptr}, **m_fr {nullptr};
+
+    // the reality is written into m_recorder, it is read from m_source
+    // instead of the scenarios
+    SamuRecorder * m_recorder {nullptr};
+    SamuSource * m_source {nullptr};
+
+    // the scenarios of m_timeline instead of the schedule: the current
+    // segment, its elapsed ticks and whether the next reality is learnt
+    const SamuTimeline * m_timeline {nullptr};
+    std::size_t m_segment {0};
+    long m_elapsed {0};
+    bool m_learning {true};
 
     void development();
+    // the reality of the next tick of the timeline, false if it is skipped
+    bool development_timeline();
     int  numberOfNeighbors ( int **lattice, int r, int c, int s );
 
-    void glider ( int **lattice, int x, int y );
-    void car ( int **lattice, int x, int y );
-    void man ( int **lattice, int x, int y );
-    void house ( int **lattice, int x, int y );
+    void gliders ( int **lattice );
+    // the sprite of the atlas at x, y (SamuSprite.h)
+    void blit ( int **lattice, SamuSpriteId id, int x, int y, int color = 1 );
 
     int carx {0};
     int manx {0};
     int housex {0};
 
-    void red ( int **lattice, int x, int y, int color );
-    void green ( int **lattice, int x, int y, int color );
-    void blue ( int **lattice, int x, int y, int color );
-
     void clear_lattice ( int **nextLattice );
     void fill_lattice ( int **nextLattice, int color );
 
@@ -98,28 +110,69 @@ class GameOfLife : public QThread
     void control_Conway ( int **, int **nextLattice );
     void control_Movie ( int **nextLattice );
 
+    // the micro-benchmarks of the kernels (bench/KernelBench.cpp)
+    friend class SamuBench;
+
 public:
     GameOfLife ( int w = 30, int h = 20 );
     ~GameOfLife();
 
-    void run();
+    // one tick: the next reality and Samu's predictions of it, false at
+    // the end of the source
+    bool step();
     int **lattice();
+    int **getPredictions() {
+        return predictions;
+    }
+    // the frequencies of the current MPU, nullptr while the brain is searching
+    int **getFp() {
+        return m_fp;
+    }
+    int **getFr() {
+        return m_fr;
+    }
     int getW() const;
     int getH() const;
     long getT() const;
-    void pause();
-    int getDelay() const {
-        return m_delay;
+    void setSchedule ( long conway, long stroop, long movie ) {
+        m_conway = conway;
+        m_stroop = stroop;
+        m_movie = movie;
+    }
+    void setRecorder ( SamuRecorder * recorder ) {
+        m_recorder = recorder;
+    }
+    // the frames of source instead of the scenarios (SamuSource.h), they
+    // are repeated from the first one if the source can be rewound
+    void setSource ( SamuSource * source ) {
+        m_source = source;
+    }
+    // it replaces the schedule, the timeline starts again at its end
+    void setTimeline ( const SamuTimeline * timeline ) {
+        m_timeline = timeline;
+        m_segment = 0;
+        m_elapsed = 0;
+        m_learning = true;
     }
-    void setDelay ( int delay ) {
-        if ( delay > 0 ) {
-            m_delay = delay;
+    int nofMPUs() const {
+        return samuBrain ? samuBrain->nofMPUs() : 0;
+    }
+    SamuBrain * getBrain() {
+        return samuBrain;
+    }
+    // the snapshots of the brain, see SamuBrain::save
+    bool save ( const char * path ) const {
+        return samuBrain->save ( path );
+    }
+    bool restore ( const char * path ) {
+        if ( !samuBrain->restore ( path ) ) {
+            return false;
         }
+        // they were the arrays of an old MPU
+        m_fp = m_fr = nullptr;
+        return true;
     }
 
-signals:
-    void cellsChanged ( int **, int **, int **, int ** );
-
 };
 
 #endif // GameOfLife_H
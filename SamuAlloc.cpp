@@ -0,0 +1,207 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuAlloc.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The counters of the threads and the replaced operator new and delete.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include "SamuAlloc.h"
+
+namespace
+{
+
+const int nof_phases {SamuAllocs::nof_phases};
+
+#ifdef SAMU_ALLOC
+struct SamuAllocSlot {
+  std::atomic<std::uint64_t> n[nof_phases];
+  std::atomic<std::uint64_t> bytes[nof_phases];
+  std::atomic<std::uint64_t> frees[nof_phases];
+};
+
+// the threads after the last slot share it
+const int nof_slots {64};
+SamuAllocSlot slots[nof_slots];
+std::atomic<int> nof_threads {0};
+
+SamuAllocSlot & slot()
+{
+  static thread_local int i {-1};
+
+  if ( i < 0 )
+    {
+      i = std::min ( nof_threads.fetch_add ( 1, std::memory_order_relaxed ), nof_slots-1 );
+    }
+
+  return slots[i];
+}
+
+void * allocate ( std::size_t size )
+{
+  SamuAllocSlot & s = slot();
+  int p = static_cast<int> ( SamuProf::current() );
+
+  s.n[p].fetch_add ( 1, std::memory_order_relaxed );
+  s.bytes[p].fetch_add ( size, std::memory_order_relaxed );
+
+  return std::malloc ( size ? size : 1 );
+}
+
+void deallocate ( void * ptr )
+{
+  if ( ptr )
+    {
+      slot().frees[static_cast<int> ( SamuProf::current() )].fetch_add ( 1, std::memory_order_relaxed );
+      std::free ( ptr );
+    }
+}
+#endif
+
+}
+
+#ifdef SAMU_ALLOC
+void * operator new ( std::size_t size )
+{
+  void * ptr = allocate ( size );
+  if ( !ptr )
+    {
+      throw std::bad_alloc();
+    }
+  return ptr;
+}
+
+void * operator new[] ( std::size_t size )
+{
+  return operator new ( size );
+}
+
+void * operator new ( std::size_t size, const std::nothrow_t & ) noexcept
+{
+  return allocate ( size );
+}
+
+void * operator new[] ( std::size_t size, const std::nothrow_t & ) noexcept
+{
+  return allocate ( size );
+}
+
+void operator delete ( void * ptr ) noexcept
+{
+  deallocate ( ptr );
+}
+
+void operator delete[] ( void * ptr ) noexcept
+{
+  deallocate ( ptr );
+}
+
+void operator delete ( void * ptr, std::size_t ) noexcept
+{
+  deallocate ( ptr );
+}
+
+void operator delete[] ( void * ptr, std::size_t ) noexcept
+{
+  deallocate ( ptr );
+}
+
+void operator delete ( void * ptr, const std::nothrow_t & ) noexcept
+{
+  deallocate ( ptr );
+}
+
+void operator delete[] ( void * ptr, const std::nothrow_t & ) noexcept
+{
+  deallocate ( ptr );
+}
+#endif
+
+bool SamuAlloc::counting()
+{
+#ifdef SAMU_ALLOC
+  return true;
+#else
+  return false;
+#endif
+}
+
+SamuAllocs SamuAlloc::snapshot()
+{
+  SamuAllocs allocs;
+
+#ifdef SAMU_ALLOC
+  int threads = std::min ( nof_threads.load ( std::memory_order_relaxed ), nof_slots );
+
+  for ( int i {0}; i<threads; ++i )
+    for ( int p {0}; p<nof_phases; ++p )
+      {
+        allocs.n[p] += slots[i].n[p].load ( std::memory_order_relaxed );
+        allocs.bytes[p] += slots[i].bytes[p].load ( std::memory_order_relaxed );
+        allocs.frees[p] += slots[i].frees[p].load ( std::memory_order_relaxed );
+      }
+#endif
+
+  return allocs;
+}
+
+void SamuAlloc::dump ( const SamuAllocs & allocs, std::ostream & out, double ticks )
+{
+  if ( !counting() )
+    {
+      out << "The allocations are not counted, build with DEFINES += SAMU_ALLOC.\n";
+      return;
+    }
+
+  out << std::left << std::setw ( 14 ) << "phase" << std::right
+      << std::setw ( 14 ) << "allocs"
+      << std::setw ( 14 ) << "bytes"
+      << std::setw ( 14 ) << "frees" << '\n';
+
+  for ( int p {0}; p<nof_phases; ++p )
+    {
+      if ( !allocs.n[p] && !allocs.frees[p] )
+        {
+          continue;
+        }
+
+      out << std::left << std::setw ( 14 ) << name ( p ) << std::right
+          << std::fixed << std::setprecision ( 1 )
+          << std::setw ( 14 ) << allocs.n[p] / ticks
+          << std::setw ( 14 ) << allocs.bytes[p] / ticks
+          << std::setw ( 14 ) << allocs.frees[p] / ticks << '\n';
+      out.unsetf ( std::ios::fixed );
+    }
+}
+
+const char * SamuAlloc::name ( int phase )
+{
+  return phase < static_cast<int> ( SamuPhase::NOF_PHASES ) ?
+         SamuProf::name ( static_cast<SamuPhase> ( phase ) ) : "none";
+}
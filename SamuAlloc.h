@@ -0,0 +1,95 @@
+#ifndef SamuAlloc_H
+#define SamuAlloc_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuAlloc.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The heap allocations per phase (SamuProf). With DEFINES += SAMU_ALLOC
+ * the global operator new and delete are replaced, they count the
+ * allocations, their bytes and the frees into the phase of the calling
+ * thread (the innermost SAMU_PHASE, or none). The counters of a thread
+ * are atomics in a fixed slot, so counting never allocates.
+ *
+ * A snapshot is the sum of all the threads, the difference of two
+ * snapshots is what a piece of code allocated, e.g. a tick:
+ *
+ *    SamuAllocs before = SamuAlloc::snapshot();
+ *    gameOfLife.step();
+ *    SamuAllocs tick = SamuAlloc::snapshot() - before;
+ */
+
+#include <cstdint>
+#include <ostream>
+#include "SamuProf.h"
+
+struct SamuAllocs {
+    static constexpr int nof_phases {static_cast<int> ( SamuPhase::NOF_PHASES ) + 1};
+
+    // the last one is outside of the phases
+    std::uint64_t n[nof_phases] {};
+    std::uint64_t bytes[nof_phases] {};
+    std::uint64_t frees[nof_phases] {};
+
+    std::uint64_t total() const {
+        std::uint64_t t {0};
+        for ( int p {0}; p<nof_phases; ++p ) {
+            t += n[p];
+        }
+        return t;
+    }
+
+    SamuAllocs & operator+= ( const SamuAllocs & o ) {
+        for ( int p {0}; p<nof_phases; ++p ) {
+            n[p] += o.n[p];
+            bytes[p] += o.bytes[p];
+            frees[p] += o.frees[p];
+        }
+        return *this;
+    }
+
+    SamuAllocs operator- ( const SamuAllocs & o ) const {
+        SamuAllocs d;
+        for ( int p {0}; p<nof_phases; ++p ) {
+            d.n[p] = n[p] - o.n[p];
+            d.bytes[p] = bytes[p] - o.bytes[p];
+            d.frees[p] = frees[p] - o.frees[p];
+        }
+        return d;
+    }
+};
+
+class SamuAlloc
+{
+public:
+    // it is false without SAMU_ALLOC, then the snapshots are empty
+    static bool counting();
+    static SamuAllocs snapshot();
+    // per phase, the counts are divided by ticks
+    static void dump ( const SamuAllocs & allocs, std::ostream & out, double ticks = 1.0 );
+    static const char * name ( int phase );
+};
+
+#endif
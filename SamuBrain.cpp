@@ -68,15 +68,13 @@ SamuBrain::~SamuBrain()
 
 }
 
-MentalProcessingUnit::MentalProcessingUnit ( int w, int h ) : m_w ( w ), m_h ( h )
+MentalProcessingUnit::MentalProcessingUnit ( int w, int h, int id ) : m_w ( w ), m_h ( h ), m_id ( id )
+#ifndef Q_LOOKUP_TABLE
+  , m_frames ( shared_image ? 1 : w*h, QlPerceptron::n_units[0] )
+#endif
 {
 
-  m_samuQl = new QL*[m_h];
-
-  for ( int i {0}; i<m_h; ++i )
-    {
-      m_samuQl[i] = new QL [m_w];
-    }
+  m_samuQl = new_cells();
 
   m_prev = new int*[m_h];
   fp = new int*[m_h];
@@ -97,6 +95,33 @@ MentalProcessingUnit::MentalProcessingUnit ( int w, int h ) : m_w ( w ), m_h ( h
 
 }
 
+MPU MentalProcessingUnit::new_cells() const
+{
+  MPU cells = new QL*[m_h];
+
+  for ( int i {0}; i<m_h; ++i )
+    {
+      cells[i] = new QL [m_w];
+
+      for ( int j {0}; j<m_w; ++j )
+        {
+          cells[i][j].tag ( m_id, i*m_w+j );
+        }
+    }
+
+  return cells;
+}
+
+void MentalProcessingUnit::delete_cells ( MPU cells ) const
+{
+  for ( int i {0}; i<m_h; ++i )
+    {
+      delete[] cells[i];
+    }
+
+  delete[] cells;
+}
+
 void MentalProcessingUnit::cls ( )
 {
   for ( int r {0}; r<m_h; ++r )
@@ -106,15 +131,207 @@ void MentalProcessingUnit::cls ( )
       }
 }
 
-MentalProcessingUnit::~MentalProcessingUnit ( )
+SamuMemory MentalProcessingUnit::memory() const
 {
+  SamuMemory m;
 
-  for ( int i {0}; i<m_h; ++i )
+  if ( m_samuQl )
+    for ( int r {0}; r<m_h; ++r )
+      for ( int c {0}; c<m_w; ++c )
+        {
+          m += m_samuQl[r][c].memory();
+        }
+#ifdef Q_LOOKUP_TABLE
+  for ( const FrozenQL & f : m_frozen )
+    {
+      m.bytes[SamuMemory::TABLE] += f.bytes();
+    }
+#endif
+
+  m.other += sizeof ( *this ) + 4*m_h*sizeof ( int * ) + 3*m_h*m_w*sizeof ( int );
+#ifndef Q_LOOKUP_TABLE
+  m.other += m_frames.bytes() - sizeof ( m_frames );
+#endif
+
+  return m;
+}
+
+bool MentalProcessingUnit::save ( SamuWriter & out )
+{
+  MPU cells = m_samuQl;
+
+  if ( !cells && ! ( cells = load() ) )
+    {
+      return false;
+    }
+
+  m_habi.save ( out );
+
+  for ( int r {0}; r<m_h; ++r )
+    {
+      out.put ( m_prev[r], m_w );
+      out.put ( fp[r], m_w );
+      out.put ( fr[r], m_w );
+    }
+
+#ifndef Q_LOOKUP_TABLE
+  m_frames.save ( out );
+#endif
+
+  save_cells ( out, cells );
+
+  if ( cells != m_samuQl )
+    {
+      delete_cells ( cells );
+    }
+
+  return true;
+}
+
+void MentalProcessingUnit::save_cells ( SamuWriter & out, MPU cells ) const
+{
+  for ( int r {0}; r<m_h; ++r )
+    for ( int c {0}; c<m_w; ++c )
+      {
+        cells[r][c].save ( out );
+#ifndef Q_LOOKUP_TABLE
+        out.put ( m_frames.offset ( cells[r][c].previousImage() ) );
+#endif
+      }
+}
+
+bool MentalProcessingUnit::restore ( SamuReader & in )
+{
+  m_habi.restore ( in );
+
+  for ( int r {0}; r<m_h; ++r )
+    {
+      in.get ( m_prev[r], m_w );
+      in.get ( fp[r], m_w );
+      in.get ( fr[r], m_w );
+    }
+
+#ifndef Q_LOOKUP_TABLE
+  if ( !m_frames.restore ( in ) )
+    {
+      return false;
+    }
+#endif
+
+  return restore_cells ( in, m_samuQl );
+}
+
+bool MentalProcessingUnit::restore_cells ( SamuReader & in, MPU cells )
+{
+  for ( int r {0}; r<m_h; ++r )
+    for ( int c {0}; c<m_w; ++c )
+      {
+        if ( !cells[r][c].restore ( in ) )
+          {
+            return false;
+          }
+#ifndef Q_LOOKUP_TABLE
+        std::int64_t offset;
+        in.get ( offset );
+        cells[r][c].setPreviousImage ( m_frames.at ( offset ) );
+#endif
+      }
+
+  return in.ok();
+}
+
+// the cells of a paged out MPU as they would be in the memory
+MPU MentalProcessingUnit::load()
+{
+  MPU cells = new_cells();
+  SamuReader in = m_store->read ( m_record );
+
+  if ( !restore_cells ( in, cells ) )
+    {
+      delete_cells ( cells );
+      return nullptr;
+    }
+
+#ifdef Q_LOOKUP_TABLE
+  for ( int r {0}; r<m_h; ++r )
+    for ( int c {0}; c<m_w; ++c )
+      {
+        m_frozen[r*m_w+c].thaw ( cells[r][c] );
+      }
+#endif
+
+  return cells;
+}
+
+bool MentalProcessingUnit::pageOut ( SamuStore & store )
+{
+  if ( !m_samuQl )
     {
-      delete[] m_samuQl[i];
+      return true;
     }
 
-  delete[] m_samuQl;
+  save_cells ( store.begin(), m_samuQl );
+  int record = store.end();
+
+  if ( !store.ok() )
+    {
+      store.free ( record );
+      return false;
+    }
+
+#ifdef Q_LOOKUP_TABLE
+  m_frozen.reserve ( m_h*m_w );
+  for ( int r {0}; r<m_h; ++r )
+    for ( int c {0}; c<m_w; ++c )
+      {
+        m_frozen.emplace_back ( m_samuQl[r][c] );
+      }
+#endif
+
+  m_store = &store;
+  m_record = record;
+
+  delete_cells ( m_samuQl );
+  m_samuQl = nullptr;
+
+  return true;
+}
+
+bool MentalProcessingUnit::pageIn()
+{
+  if ( m_samuQl )
+    {
+      return true;
+    }
+
+  MPU cells = load();
+
+  if ( !cells )
+    {
+      return false;
+    }
+
+  m_samuQl = cells;
+  m_store->free ( m_record );
+  m_record = -1;
+#ifdef Q_LOOKUP_TABLE
+  std::vector<FrozenQL>().swap ( m_frozen );
+#endif
+
+  return true;
+}
+
+MentalProcessingUnit::~MentalProcessingUnit ( )
+{
+
+  if ( m_samuQl )
+    {
+      delete_cells ( m_samuQl );
+    }
+  else
+    {
+      m_store->free ( m_record );
+    }
 
   for ( int i {0}; i<m_h; ++i )
     {
@@ -128,7 +345,7 @@ MentalProcessingUnit::~MentalProcessingUnit ( )
 MORGAN SamuBrain::newMPU ()
 {
 
-  MORGAN morgan = new MentalProcessingUnit ( m_w, m_h );
+  MORGAN morgan = new MentalProcessingUnit ( m_w, m_h, m_brain.size() );
 
   std::stringstream ss;
   ss << "Foobar";
@@ -138,6 +355,11 @@ MORGAN SamuBrain::newMPU ()
 
   m_brain[mpuName] = morgan;
 
+  if ( SamuJournal::on() )
+    {
+      SamuJournal::mpu ( morgan->getId(), mpuName );
+    }
+
   return morgan;
 }
 
@@ -167,6 +389,222 @@ int SamuBrain::nofMPUs() const
   return m_brain.size();
 }
 
+SamuMemory SamuBrain::memory() const
+{
+  SamuMemory m;
+
+  for ( const auto& mpu : m_brain )
+    {
+      m += mpu.second->memory();
+      m.other += SamuMemory::heap ( mpu.first ) + sizeof ( mpu ) + 4*sizeof ( void * );
+    }
+
+  return m;
+}
+
+void SamuBrain::log_memory() const
+{
+  static_assert ( SamuMemory::NOF_PARTS == 5, "SamuRecord::sizes" );
+
+  SamuMemory brain;
+
+  auto log = [this] ( const std::string & name, const SamuMemory & m )
+  {
+    std::uint64_t bytes[SamuMemory::NOF_PARTS], entries[SamuMemory::NOF_PARTS];
+
+    for ( int p {0}; p<SamuMemory::NOF_PARTS; ++p )
+      {
+        bytes[p] = m.bytes[p];
+        entries[p] = m.entries[p];
+      }
+
+    SamuLog::log ( SamuEvent::MEMORY, m_internal_clock, name, m.total() );
+    SamuLog::log ( SamuEvent::MEMORY_BYTES, m_internal_clock, bytes );
+    SamuLog::log ( SamuEvent::MEMORY_ENTRIES, m_internal_clock, entries );
+  };
+
+  for ( const auto& mpu : m_brain )
+    {
+      SamuMemory m = mpu.second->memory();
+      brain += m;
+      log ( mpu.first, m );
+    }
+
+  log ( "SamuBrain", brain );
+}
+
+namespace
+{
+
+const char magic[8] = {'S', 'A', 'M', 'U', 'S', 'N', 'A', 'P'};
+const std::uint32_t version {3};
+
+// the build options that change the layout of an MPU
+std::uint32_t layout()
+{
+  std::uint32_t l {0};
+#ifdef Q_LOOKUP_TABLE
+  l |= 1u;
+#else
+  l |= QlPerceptron::n_weights() << 8;
+#endif
+#ifdef SHARED_TRUNK
+  l |= 2u;
+#endif
+
+  return l;
+}
+
+}
+
+bool SamuBrain::save ( const char * path ) const
+{
+#ifdef FEELINGS
+  // the perceptrons of the feelings are not in the snapshots
+  ( void ) path;
+  return false;
+#else
+  std::ofstream file ( path, std::ios::binary | std::ios::trunc );
+  SamuWriter out ( file );
+
+  out.put ( magic, sizeof ( magic ) );
+  out.put ( version );
+  out.put ( layout() );
+  out.put ( m_w );
+  out.put ( m_h );
+  out.put ( m_neighbourhood.shape() );
+  out.put ( m_neighbourhood.radius() );
+  out.put ( m_neighbourhood.colors() );
+
+  out.put ( m_internal_clock );
+  out.put ( m_haveAlreadyLearnt );
+  out.put ( m_searching );
+  out.put ( m_haveAlreadyLearntTime );
+  out.put ( m_maxLearningTime );
+  out.put ( m_searchingStart );
+  out.put ( m_habituation );
+
+  out.put ( get_foobar() );
+  out.put<std::uint32_t> ( m_brain.size() );
+
+  for ( const auto& mpu : m_brain )
+    {
+      out.put ( mpu.first );
+      out.put ( mpu.second->getId() );
+
+      if ( !mpu.second->save ( out ) )
+        {
+          file.close();
+          std::remove ( path );
+          return false;
+        }
+    }
+
+  file.flush();
+
+  return out.ok();
+#endif
+}
+
+bool SamuBrain::restore ( const char * path )
+{
+  SamuMapping mapping ( path );
+
+  if ( !mapping.ok() )
+    {
+      return false;
+    }
+
+  SamuReader in ( mapping.begin(), mapping.end() );
+
+  char m[sizeof ( magic )];
+  std::uint32_t v, l;
+  int w, h;
+
+  in.get ( m, sizeof ( m ) );
+  in.get ( v );
+  in.get ( l );
+  in.get ( w );
+  in.get ( h );
+
+  SamuShape shape;
+  int radius, colors;
+
+  in.get ( shape );
+  in.get ( radius );
+  in.get ( colors );
+
+  if ( !in.ok() || std::memcmp ( m, magic, sizeof ( magic ) )
+       || v != version || l != layout() || w != m_w || h != m_h
+       || ! ( SamuNeighbourhood ( shape, radius, colors ) == m_neighbourhood ) )
+    {
+      return false;
+    }
+
+  long internal_clock;
+  bool haveAlreadyLearnt, searching, habituation;
+  int haveAlreadyLearntTime, maxLearningTime, searchingStart;
+
+  in.get ( internal_clock );
+  in.get ( haveAlreadyLearnt );
+  in.get ( searching );
+  in.get ( haveAlreadyLearntTime );
+  in.get ( maxLearningTime );
+  in.get ( searchingStart );
+  in.get ( habituation );
+
+  std::string current;
+  std::uint32_t n;
+
+  in.get ( current );
+  in.get ( n );
+
+  // the new MPUs replace the old ones only if all of them have been read
+  std::map<std::string, MORGAN> brain;
+  bool ok = in.ok();
+
+  for ( std::uint32_t i {0}; i<n && ok; ++i )
+    {
+      std::string name;
+      int id;
+      in.get ( name );
+      in.get ( id );
+
+      MORGAN morgan = new MentalProcessingUnit ( m_w, m_h, id );
+      brain.emplace_hint ( brain.end(), name, morgan );
+
+      ok = in.ok() && morgan->restore ( in );
+    }
+
+  if ( !ok || brain.find ( current ) == brain.end() )
+    {
+      for ( auto& mpu : brain )
+        {
+          delete mpu.second;
+        }
+
+      return false;
+    }
+
+  for ( auto& mpu : m_brain )
+    {
+      delete mpu.second;
+    }
+
+  m_brain.swap ( brain );
+  m_morgan = m_brain[current];
+
+  m_internal_clock = internal_clock;
+  m_haveAlreadyLearnt = haveAlreadyLearnt;
+  m_searching = searching;
+  m_haveAlreadyLearntTime = haveAlreadyLearntTime;
+  m_maxLearningTime = maxLearningTime;
+  m_searchingStart = searchingStart;
+  m_habituation = habituation;
+
+  return true;
+}
+
 /*
 double SamuBrain::howMuchLearned() const
 {
@@ -299,77 +737,88 @@ int SamuBrain::pred ( MORGAN morgan, int **reality, int **predictions, int isLea
 }
 */
 
+// the state of the cell and the colors of its neighbours (on a torus): "s|n0|n1|n2|n3|n4";
+// the cells of a row are encoded in order from c = 0, window is the histogram of the
+// neighbourhood of the previous cell of the row (SamuNeighbourhood)
+std::string SamuBrain::encoding ( int **reality, int r, int c, int window[], int colors[] ) const
+{
+  if ( c == 0 )
+    {
+      m_neighbourhood.first ( r, window );
+    }
+  else
+    {
+      m_neighbourhood.slide ( r, c-1, window );
+    }
+
+  int state = reality[r][c];
+
+  for ( int ci {0}; ci<m_neighbourhood.colors(); ++ci )
+    {
+      colors[ci] = window[ci] - ( state == ci );
+    }
+
+  char key[SamuNeighbourhood::max_key];
+
+  return std::string ( key, m_neighbourhood.key ( key, state, colors ) );
+}
+
 int SamuBrain::pred ( MORGAN morgan, int **reality, int **predictions, int isLearning, int & vsum )
 {
+  SAMU_PHASE ( PRED );
+
+#ifdef Q_LOOKUP_TABLE
+  // a paged out MPU is searched in its frozen form, it is paged in to learn
+  FrozenQL * frozen = isLearning ? morgan->getFrozen() : nullptr;
+
+  if ( !morgan->isResident() && !frozen )
+#else
+  if ( !morgan->isResident() )
+#endif
+    {
+      fault ( morgan );
+    }
 
   MPU samuQl = morgan->getSamu();
   int ** prev = morgan->getPrev();
   int ** fp = morgan->getFp();
   int ** fr = morgan->getFr();
 
-  //double img_input[40];
-  int colors[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
   int sum {0};
+  int nvsum {0};
 
-  vsum = 0;
+#ifndef Q_LOOKUP_TABLE
+  FrameStore & frames = morgan->getFrames();
+  double *frame = frames.next();
 
-  for ( int r {0}; r<m_h; ++r )
+  if ( shared_image )
     {
-      for ( int c {0}; c<m_w; ++c )
+      for ( int i {0}; i<frames.inputs() && i<m_h*m_w; ++i )
         {
+          frame[i] = reality[i/m_w][i%m_w];
+        }
+    }
+#endif
 
-          std::stringstream ss;
-          int ii {0};
-
-          for ( int ci {0}; ci<5; ++ci )
-            {
-              colors[ci] = 0;
-            }
-
-          for ( int i {-1}; i<2; ++i )
-            for ( int j {-1}; j<2; ++j )
-
-              if ( ! ( ( i==0 ) && ( j==0 ) ) )
-
-                {
-                  int o = c + j;
-                  if ( o < 0 )
-                    {
-                      o = m_w-1;
-                    }
-                  else if ( o >= m_w )
-                    {
-                      o = 0;
-                    }
-
-                  int s = r + i;
-                  if ( s < 0 )
-                    {
-                      s = m_h-1;
-                    }
-                  else if ( s >= m_h )
-                    {
-                      s = 0;
-                    }
-
-                  ++colors[reality[s][o]];
-
+  // in PRED, the ENCODING samples are the cells
+  m_neighbourhood.prepare ( reality, m_w, m_h );
 
-                } // if
+  // each cell has its own QL, so the rows are independent
+  #pragma omp parallel for reduction ( +:sum, nvsum )
+  for ( int r = 0; r<m_h; ++r )
+    {
+      //double img_input[40];
+      int colors[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+      int window[SamuNeighbourhood::max_colors];
 
-          ss << reality[r][c];
-          ss << '|';
-          ss << colors[0]; //img_input[1];
-          ss << '|';
-          ss << colors[1];
-          ss << '|';
-          ss << colors[2];
-          ss << '|';
-          ss << colors[3];
-          ss << '|';
-          ss << colors[4];
+      for ( int c {0}; c<m_w; ++c )
+        {
 
-          std::string prg = ss.str();
+          std::string prg;
+          {
+            SAMU_CELL_PHASE ( ENCODING );
+            prg = encoding ( reality, r, c, window, colors );
+          }
 
           // with NNs
           //SPOTriplet response = samuQl[r][c] ( lattice[r][c], prg, img_input );
@@ -378,12 +827,36 @@ int SamuBrain::pred ( MORGAN morgan, int **reality, int **predictions, int isLea
           //  prev[r][c] = samuQl[r][c].action();// mintha a samuQl hívása után a predikciót mentettem volna el (B)
           //predictions[r][c] =  prev[r][c];
 
-          SPOTriplet response = samuQl[r][c] ( reality[r][c], prg, isLearning == 0 );
+          SPOTriplet response;
+          {
+            SAMU_CELL_PHASE ( QL );
+
+#ifdef Q_LOOKUP_TABLE
+            if ( frozen )
+              {
+                response = frozen[r*m_w+c] ( reality[r][c], prg );
+              }
+            else
+              {
+                response = samuQl[r][c] ( reality[r][c], prg, isLearning == 0 );
+              }
+#else
+            double *image = frames.image ( shared_image ? 0 : r*m_w+c );
+
+            if ( !shared_image )
+              {
+                image[0] = reality[r][c];
+                image[1] = ( m_neighbourhood.size()-colors[0] ) / static_cast<double> ( m_neighbourhood.size() );
+              }
+
+            response = samuQl[r][c] ( reality[r][c], prg, image );
+#endif
+          }
 
           if ( reality[r][c] )
             //if ( ( predictions[r][c] == reality[r][c] ) && ( reality[r][c] != 0 ) )
             {
-              ++vsum;
+              ++nvsum;
               //if (  samuQl[r][c].reward() == samuQl[r][c].get_max_reward()/*reality[r][c] == prev[r][c]*/ )
               if ( reality[r][c] == prev[r][c] )
                 {
@@ -412,7 +885,11 @@ int SamuBrain::pred ( MORGAN morgan, int **reality, int **predictions, int isLea
               }
 
 
+#ifdef Q_LOOKUP_TABLE
+            fr[r][c] = frozen ? frozen[r*m_w+c].getNumRules() : samuQl[r][c].getNumRules();
+#else
             fr[r][c] = samuQl[r][c].getNumRules();
+#endif
 
           }
 
@@ -443,6 +920,8 @@ int SamuBrain::pred ( MORGAN morgan, int **reality, int **predictions, int isLea
 
     }
 
+  vsum = nvsum;
+
   return sum;
 }
 
@@ -504,6 +983,7 @@ bool Habituation::is_newinput ( int vsum, int sum ) //, double &mon )
 
 bool Habituation::is_habituation ( int vsum, int sum, double &mon )
 {
+  SAMU_PHASE ( HABITUATION );
 
   int ssum {0};
   int svsum {0};
@@ -528,11 +1008,14 @@ bool Habituation::is_habituation ( int vsum, int sum, double &mon )
   z = mavsum - asum[ma_limit-1];
 
 
-  qDebug() << "   HABITUATION MONITOR:"
-           << "(isHABI MPU)"
-           << vsum << sum << mavsum << masum
-           << masum - msum[ma_limit-1]
-           << mavsum - asum[ma_limit-1];
+  if ( SamuLog::enabled ( SamuEvent::IS_HABITUATION ) )
+    {
+      int sums[6] = {vsum, sum, mavsum, masum,
+                     masum - msum[ma_limit-1],
+                     mavsum - asum[ma_limit-1]
+                    };
+      SamuLog::log ( SamuEvent::IS_HABITUATION, sums );
+    }
 
   if ( q != 0
        && q == w
@@ -602,16 +1085,27 @@ bool Habituation::is_habituation ( int vsum, int sum, double &mon )
 
 void SamuBrain::learning ( int **reality, int **predictions, int ***fp, int ***fr )
 {
+  SAMU_PHASE ( LEARNING );
+
   this->fp = fp;
   this->fr = fr;
 
   ++m_internal_clock;
 
+  SamuJournal::begin ( m_internal_clock );
+
+  if ( m_memoryEvery && m_internal_clock % m_memoryEvery == 0
+       && SamuLog::enabled ( SamuEvent::MEMORY ) )
+    {
+      log_memory();
+    }
+
   int sum {0};
   int vsum {0};
 
   if ( m_searching )
     {
+      SAMU_PHASE ( SEARCH );
 
       * ( this->fp ) = nullptr ;
       * ( this->fr ) = nullptr ;
@@ -630,11 +1124,11 @@ void SamuBrain::learning ( int **reality, int **predictions, int ***fp, int ***f
           bool habi =
             h.is_habituation ( vsum, sum, mon );
 
-          qDebug() << "   HABITUATION MONITOR:"
-                   << m_internal_clock
-                   << "[SEARCHING] MPU:" << mpu.first.c_str()
-                   << "bogocertainty of convergence:"
-                   << mon*100 << "%";
+          SamuLog::log ( SamuEvent::SEARCHING, m_internal_clock, mpu.first, mon*100 );
+          if ( mon >= 0.0 )
+            {
+              SamuTrace::counter ( SamuCounter::CONVERGENCE, m_internal_clock, mon*100, mpu.first );
+            }
 
           if ( habi || mon >= .9 )
             {
@@ -655,22 +1149,16 @@ void SamuBrain::learning ( int **reality, int **predictions, int ***fp, int ***f
             {
               m_morgan = newMPU();
 
-              qDebug() << "   SENSITIZATION MONITOR:"
-                       << m_internal_clock
-                       << "MPU-notion:" << get_foobar ( ).c_str()
-                       << "(new MPU, searching time)"
-                       << t;
+              SamuLog::log ( SamuEvent::NEW_MPU, m_internal_clock, get_foobar ( ), 0.0, t );
+              SamuTrace::instant ( SamuEvent::NEW_MPU, m_internal_clock, get_foobar ( ), t );
 
             }
           else
             {
               m_morgan = maxSamuQl;
 
-              qDebug() << "   SENSITIZATION MONITOR:"
-                       << m_internal_clock
-                       << "MPU-notion:" << get_foobar ( ).c_str()
-                       << "(recognized MPU, searching time)"
-                       << t;
+              SamuLog::log ( SamuEvent::RECOGNIZED_MPU, m_internal_clock, get_foobar ( ), 0.0, t );
+              SamuTrace::instant ( SamuEvent::RECOGNIZED_MPU, m_internal_clock, get_foobar ( ), t );
 
             }
 
@@ -696,15 +1184,18 @@ void SamuBrain::learning ( int **reality, int **predictions, int ***fp, int ***f
       Habituation& h = m_morgan->getHabituation();
       m_habituation = h.is_habituation ( vsum, sum, mon );
 
+      if ( mon >= 0.0 && SamuTrace::on() )
+        {
+          SamuTrace::counter ( SamuCounter::CONVERGENCE, m_internal_clock, mon*100, get_foobar ( ) );
+        }
+
       if ( !m_haveAlreadyLearnt )
         {
 
-          qDebug() << "   HABITUATION MONITOR:"
-                   << m_internal_clock
-                   << "[LEARNING]"
-                   << get_foobar ( ).c_str()
-                   << "bogocertainty of convergence:"
-                   << mon*100 << "%";
+          if ( SamuLog::enabled ( SamuEvent::LEARNING ) )
+            {
+              SamuLog::log ( SamuEvent::LEARNING, m_internal_clock, get_foobar ( ), mon*100 );
+            }
 
           if ( m_habituation )
             {
@@ -717,11 +1208,8 @@ void SamuBrain::learning ( int **reality, int **predictions, int ***fp, int ***f
                   m_maxLearningTime = t;
                 }
 
-              qDebug() << "   HIGHER-ORDER NOTION MONITOR:"
-                       << m_internal_clock
-                       << "MPU-notion:" << get_foobar ( ).c_str()
-                       << "(learning time)"
-                       << t;
+              SamuLog::log ( SamuEvent::LEARNING_TIME, m_internal_clock, get_foobar ( ), 0.0, t );
+              SamuTrace::instant ( SamuEvent::LEARNING_TIME, m_internal_clock, get_foobar ( ), t );
 
             }
 
@@ -729,18 +1217,15 @@ void SamuBrain::learning ( int **reality, int **predictions, int ***fp, int ***f
       else // már "megtanulta"
         {
 
-          qDebug() << "   HABITUATION MONITOR:"
-                   << m_internal_clock
-                   << "[LEARNED]"
-                   << get_foobar ( ).c_str()
-                   << "bogocertainty of convergence:"
-                   << mon*100 << "%";
+          if ( SamuLog::enabled ( SamuEvent::LEARNED ) )
+            {
+              SamuLog::log ( SamuEvent::LEARNED, m_internal_clock, get_foobar ( ), mon*100 );
+            }
 
           if ( h.is_newinput ( vsum, sum ) && !m_habituation && mon != -1.0  /*&& mon != 1.0*/ )
             {
-              qDebug() << "   SENSITIZATION MONITOR:"
-                       << m_internal_clock
-                       << "(new input detected)";
+              SamuLog::log ( SamuEvent::NEW_INPUT, m_internal_clock );
+              SamuTrace::instant ( SamuEvent::NEW_INPUT, m_internal_clock );
 
               m_searching = true;
               m_searchingStart = m_internal_clock;
@@ -757,6 +1242,114 @@ void SamuBrain::learning ( int **reality, int **predictions, int ***fp, int ***f
 
     }
 
+  if ( m_store )
+    {
+      m_morgan->use ( m_internal_clock );
+      page_out();
+    }
+
+  if ( SamuJournal::on() )
+    {
+      SamuJournal::end ( *this );
+    }
+
+}
+
+bool SamuBrain::setNeighbourhood ( const SamuNeighbourhood & neighbourhood )
+{
+  // the keys of the learnt tables are of the old one
+  if ( !neighbourhood.valid() || neighbourhood.width() > SamuNeighbourhood::max_key
+       || m_internal_clock || m_brain.size() > 1 )
+    {
+      return false;
+    }
+
+  m_neighbourhood = neighbourhood;
+
+  return true;
+}
+
+bool SamuBrain::setPaging ( const char * path, int idle )
+{
+  for ( auto& mpu : m_brain )
+    if ( !mpu.second->isResident() )
+      {
+        fault ( mpu.second );
+      }
+
+  m_store.reset ( new SamuStore );
+  m_idle = idle;
+
+  if ( !m_store->open ( path ) )
+    {
+      m_store.reset();
+      return false;
+    }
+
+  return true;
+}
+
+void SamuBrain::fault ( MORGAN morgan )
+{
+  auto start = std::chrono::steady_clock::now();
+
+  if ( !morgan->pageIn() )
+    {
+      std::cerr << "Cannot page in " << get_foobar ( morgan ) << std::endl;
+      std::abort();
+    }
+
+  std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+
+  ++m_faults;
+  m_faultMs += d.count();
+  morgan->use ( m_internal_clock );
+}
+
+// the MPUs that have not been current (or paged in) for m_idle ticks
+void SamuBrain::page_out()
+{
+  for ( auto& mpu : m_brain )
+    {
+      MORGAN morgan = mpu.second;
+
+      if ( morgan != m_morgan && morgan->isResident()
+           && m_internal_clock - morgan->getUsed() >= m_idle
+           && morgan->pageOut ( *m_store ) )
+        {
+          ++m_pageOuts;
+        }
+    }
+}
+
+SamuResidency SamuBrain::residency() const
+{
+  SamuResidency r;
+
+  for ( const auto& mpu : m_brain )
+    {
+      if ( mpu.second->isResident() )
+        {
+          ++r.resident;
+        }
+      else
+        {
+          ++r.paged;
+          r.frozenBytes += mpu.second->memory().bytes[SamuMemory::TABLE];
+        }
+    }
+
+  r.faults = m_faults;
+  r.pageOuts = m_pageOuts;
+  r.faultMs = m_faultMs;
+
+  if ( m_store )
+    {
+      r.storeBytes = m_store->bytes();
+      r.storeLive = m_store->live();
+    }
+
+  return r;
 }
 
 void SamuBrain::init_MPUs ( bool ex )
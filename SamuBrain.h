@@ -51,13 +51,18 @@
  * https://youtu.be/VujHHeYuzIk
  */
 
-#include <QThread>
-#include <QDebug>
 #include <sstream>
+#include "SamuLog.h"
+#include "SamuProf.h"
+#include "SamuJournal.h"
+#include "SamuNeighbourhood.h"
 #include "SamuQl.h"
+#include "SamuTrace.h"
 #include <vector>
 #include <set>
+#include <cstdio>
 #include <cstdlib>
+#include <memory>
 
 class Habituation
 {
@@ -98,27 +103,101 @@ public:
 
     }
 
+    void save ( SamuWriter & out ) const {
+        out.put ( mem );
+        out.put ( err );
+        out.put ( msum, ma_limit );
+        out.put ( asum, ma_limit );
+        out.put ( masum );
+        out.put ( mavsum );
+    }
+
+    bool restore ( SamuReader & in ) {
+        in.get ( mem );
+        in.get ( err );
+        in.get ( msum, ma_limit );
+        in.get ( asum, ma_limit );
+        in.get ( masum );
+        in.get ( mavsum );
+
+        return in.ok();
+    }
+
 };
 
 typedef QL** MPU;
 
+#ifndef Q_LOOKUP_TABLE
+#ifdef LIFEOFGAME
+// each cell has its own image: its color and the ratio of its non-empty neighbours
+const bool shared_image {false};
+#else
+// all cells see the same image: the reality lattice itself
+const bool shared_image {true};
+#endif
+#endif
+
 class MentalProcessingUnit
 {
     int m_w {40}, m_h {30};
+    // the number of the MPU in its brain (the n of Foobar<n>)
+    int m_id {0};
+    // nullptr while the MPU is paged out
     MPU m_samuQl;
     Habituation m_habi;
+#ifndef Q_LOOKUP_TABLE
+    FrameStore m_frames;
+#else
+    // the cells of a paged out MPU for searching
+    std::vector<FrozenQL> m_frozen;
+#endif
 
     int **m_prev;
     int** fr;
     int** fp;
 
+    // the record of the cells of a paged out MPU
+    SamuStore * m_store {nullptr};
+    int m_record {-1};
+    // the last tick when it was current
+    long m_used {0};
+
+    MPU new_cells() const;
+    void delete_cells ( MPU cells ) const;
+    void save_cells ( SamuWriter & out, MPU cells ) const;
+    bool restore_cells ( SamuReader & in, MPU cells );
+    MPU load();
+
 public:
-    MentalProcessingUnit ( int w = 30, int h = 20 );
+    MentalProcessingUnit ( int w = 30, int h = 20, int id = 0 );
     ~MentalProcessingUnit();
 
     MPU getSamu() {
         return m_samuQl;
     }
+    int getId() const {
+        return m_id;
+    }
+    bool isResident() const {
+        return m_samuQl != nullptr;
+    }
+#ifdef Q_LOOKUP_TABLE
+    // nullptr unless the MPU is paged out, the cells are in rows
+    FrozenQL * getFrozen() {
+        return m_frozen.empty() ? nullptr : m_frozen.data();
+    }
+#endif
+    long getUsed() const {
+        return m_used;
+    }
+    void use ( long clock ) {
+        m_used = clock;
+    }
+
+    // the cells are written into the store and freed (a frozen copy of the
+    // Q tables stays for searching), and they are read back
+    bool pageOut ( SamuStore & store );
+    bool pageIn();
     int ** getPrev() {
         return m_prev;
     }
@@ -131,13 +210,38 @@ public:
     Habituation& getHabituation() {
         return m_habi;
     }
+#ifndef Q_LOOKUP_TABLE
+    FrameStore& getFrames() {
+        return m_frames;
+    }
+#endif
 
     void cls();
 
+    // its cells and its own arrays (in other)
+    SamuMemory memory() const;
+
+    // the snapshot of the MPU, see SamuBrain::save
+    // false if it is paged out and its record cannot be read
+    bool save ( SamuWriter & out );
+    bool restore ( SamuReader & in );
+
 };
 
 typedef MentalProcessingUnit* MORGAN;
 
+// the MPUs in the memory and in the store of a brain, see SamuBrain::setPaging
+struct SamuResidency {
+    int resident {0};
+    int paged {0};
+    std::uint64_t faults {0};
+    std::uint64_t pageOuts {0};
+    double faultMs {0.0};
+    std::size_t frozenBytes {0};
+    std::uint64_t storeBytes {0};
+    std::uint64_t storeLive {0};
+};
+
 class SamuBrain
 {
 
@@ -154,16 +258,36 @@ class SamuBrain
     int m_maxLearningTime {0};
     int m_searchingStart {0};
     bool m_habituation {false};
+    int m_memoryEvery {0};
 
     MORGAN newMPU ();
+    // the neighbourhood of the cells in their keys, see setNeighbourhood
+    SamuNeighbourhood m_neighbourhood;
+    std::string encoding ( int **reality, int r, int c, int window[], int colors[] ) const;
     int pred ( int **reality, int **predictions, int, int & );
     int pred ( MORGAN, int **reality, int **predictions, int, int & );
     void init_MPUs ( bool ex );
     std::string get_foobar ( MORGAN ) const;
+    void log_memory() const;
+
+    // the paged out MPUs, see setPaging
+    std::unique_ptr<SamuStore> m_store;
+    int m_idle {0};
+    std::uint64_t m_faults {0};
+    std::uint64_t m_pageOuts {0};
+    double m_faultMs {0.0};
+
+    void fault ( MORGAN );
+    void page_out();
 
     int *** fp;
     int *** fr;
 
+    // the micro-benchmarks of the kernels (bench/KernelBench.cpp)
+    friend class SamuBench;
+    // the deltas of the counters and of the MPUs
+    friend class SamuJournal;
+
 public:
     SamuBrain ( int w = 30, int h = 20 );
     ~SamuBrain();
@@ -178,6 +302,45 @@ public:
     bool isHabituation() const {
         return m_habituation;
     }
+    // the current MPU has already learnt its input (the LEARNED state)
+    bool haveAlreadyLearnt() const {
+        return !m_searching && m_haveAlreadyLearnt;
+    }
+
+    /**
+     * The binary snapshot of the brain (SamuSnapshot.h): the counters of
+     * the brain and every MPU with its name. A snapshot can be restored
+     * only into a brain of the same size, neighbourhood and build. If the
+     * restore fails, the brain is not changed.
+     */
+    bool save ( const char * path ) const;
+    bool restore ( const char * path );
+
+    /**
+     * The MPUs that have not been current for idle ticks are paged out
+     * into the store at path. The Q-table builds search them in their
+     * frozen form and page in only the one that becomes current, the NN
+     * builds page in all of them to search (they learn while searching).
+     */
+    bool setPaging ( const char * path, int idle );
+    SamuResidency residency() const;
+
+    /**
+     * The neighbourhood and the colors in the keys of the cells (Moore of
+     * radius 1 and 5 colors by default). It can be changed only before the
+     * first tick, it is in the snapshots.
+     */
+    bool setNeighbourhood ( const SamuNeighbourhood & neighbourhood );
+    const SamuNeighbourhood & getNeighbourhood() const {
+        return m_neighbourhood;
+    }
+
+    // the sum of the MPUs
+    SamuMemory memory() const;
+    // the memory of the MPUs is written into the monitor stream in every n ticks (0: never)
+    void setMemorySampling ( int every ) {
+        m_memoryEvery = every;
+    }
 
 };
 
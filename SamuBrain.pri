@@ -0,0 +1,16 @@
+# The build configuration shared by the core library and its clients,
+# the layout of the classes depends on these defines.
+
+DEFINES += LIFEOFGAME
+#DEFINES += SARSA
+#DEFINES += SHARED_TRUNK
+#DEFINES += FAST_SIGMOID
+#DEFINES += SAMU_PROFILE
+#DEFINES += SAMU_TRACE
+#DEFINES += SAMU_ALLOC
+DEFINES += Q_LOOKUP_TABLE
+
+CONFIG += c++14
+QMAKE_CXXFLAGS += -fopenmp -fno-trapping-math
+LIBS += -fopenmp
+INCLUDEPATH += $$PWD
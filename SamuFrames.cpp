@@ -0,0 +1,329 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuFrames.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The encoding and the decoding of the frames of a recorded reality.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "SamuFrames.h"
+
+namespace
+{
+
+const char magic[8] = {'S', 'A', 'M', 'U', 'F', 'R', 'M', 'S'};
+const std::uint32_t version {1};
+
+// a run of changed cells goes on over less than this many unchanged ones,
+// they are cheaper as nibbles than as a new pair of runs
+const int gap {3};
+
+// it writes at most 10 bytes
+int put_varint ( std::uint8_t * out, std::uint64_t value )
+{
+  int n {0};
+
+  while ( value >= 0x80 )
+    {
+      out[n++] = static_cast<std::uint8_t> ( value | 0x80 );
+      value >>= 7;
+    }
+  out[n++] = static_cast<std::uint8_t> ( value );
+
+  return n;
+}
+
+void put_varint ( std::vector<std::uint8_t> & out, std::uint64_t value )
+{
+  std::uint8_t bytes[10];
+  out.insert ( out.end(), bytes, bytes + put_varint ( bytes, value ) );
+}
+
+bool get_varint ( const std::uint8_t * & p, const std::uint8_t * end, std::uint64_t & value )
+{
+  value = 0;
+
+  for ( int shift {0}; p < end && shift < 64; shift += 7 )
+    {
+      std::uint8_t b = *p++;
+      value |= static_cast<std::uint64_t> ( b & 0x7f ) << shift;
+
+      if ( ! ( b & 0x80 ) )
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+// the ticks start from -1
+std::uint64_t zigzag ( long tick )
+{
+  return tick < 0 ? 2*static_cast<std::uint64_t> ( -tick ) - 1 : 2*static_cast<std::uint64_t> ( tick );
+}
+
+long unzigzag ( std::uint64_t value )
+{
+  return value & 1 ? - static_cast<long> ( ( value+1 ) /2 ) : static_cast<long> ( value/2 );
+}
+
+}
+
+bool SamuRecorder::open ( const char * path, int w, int h )
+{
+  m_w = w;
+  m_h = h;
+
+  prev.assign ( static_cast<std::size_t> ( w ) *h, 0 );
+  cur.assign ( prev.size(), 0 );
+  buffer.clear();
+  nofFrames = 0;
+
+  file.close();
+  file.clear();
+  file.open ( path, std::ios::binary | std::ios::trunc );
+
+  std::int32_t size[2] = {w, h};
+
+  file.write ( magic, sizeof ( magic ) );
+  file.write ( reinterpret_cast<const char *> ( &version ), sizeof ( version ) );
+  file.write ( reinterpret_cast<const char *> ( size ), sizeof ( size ) );
+
+  nofBytes = sizeof ( magic ) + sizeof ( version ) + sizeof ( size );
+
+  return static_cast<bool> ( file );
+}
+
+bool SamuRecorder::write ( int ** lattice, long tick )
+{
+  if ( !file.is_open() )
+    {
+      return false;
+    }
+
+  std::uint8_t * cell = cur.data();
+
+  for ( int r {0}; r<m_h; ++r )
+    for ( int c {0}; c<m_w; ++c )
+      {
+        if ( static_cast<unsigned> ( lattice[r][c] ) > 15u )
+          {
+            file.setstate ( std::ios::failbit );
+            return false;
+          }
+        *cell++ = static_cast<std::uint8_t> ( lattice[r][c] );
+      }
+
+  buffer.clear();
+  put_varint ( buffer, zigzag ( tick ) );
+
+  int n = m_w*m_h;
+  int i {0};
+
+  while ( i < n )
+    {
+      int skip {i};
+
+      while ( i < n && cur[i] == prev[i] )
+        {
+          ++i;
+        }
+
+      put_varint ( buffer, i - skip );
+
+      if ( i == n )
+        {
+          break;
+        }
+
+      int last {i};
+
+      for ( int j {i}; j < n && j - last < gap; ++j )
+        if ( cur[j] != prev[j] )
+          {
+            last = j+1;
+          }
+
+      int run = last - i;
+      put_varint ( buffer, run );
+
+      for ( int k {0}; k<run; k += 2 )
+        {
+          std::uint8_t hi = k+1 < run ? cur[i+k+1] : 0;
+          buffer.push_back ( static_cast<std::uint8_t> ( cur[i+k] | hi << 4 ) );
+        }
+
+      i = last;
+    }
+
+  prev.swap ( cur );
+
+  std::uint8_t size[10];
+  int m = put_varint ( size, buffer.size() );
+
+  file.write ( reinterpret_cast<const char *> ( size ), m );
+  file.write ( reinterpret_cast<const char *> ( buffer.data() ), buffer.size() );
+
+  ++nofFrames;
+  nofBytes += m + buffer.size();
+
+  return static_cast<bool> ( file );
+}
+
+void SamuRecorder::close()
+{
+  file.close();
+}
+
+bool SamuReplay::open ( const char * path )
+{
+  mapping.reset ( new SamuMapping ( path ) );
+  first = p = end = nullptr;
+  nofFrames = 0;
+
+  std::int32_t size[2];
+  std::uint32_t v;
+  std::size_t header = sizeof ( magic ) + sizeof ( v ) + sizeof ( size );
+
+  if ( !mapping->ok()
+       || static_cast<std::size_t> ( mapping->end() - mapping->begin() ) < header
+       || std::memcmp ( mapping->begin(), magic, sizeof ( magic ) ) )
+    {
+      return false;
+    }
+
+  std::memcpy ( &v, mapping->begin() + sizeof ( magic ), sizeof ( v ) );
+  std::memcpy ( size, mapping->begin() + sizeof ( magic ) + sizeof ( v ), sizeof ( size ) );
+
+  if ( v != version || size[0] <= 0 || size[1] <= 0 )
+    {
+      return false;
+    }
+
+  m_w = size[0];
+  m_h = size[1];
+
+  cells.assign ( static_cast<std::size_t> ( m_w ) *m_h, 0 );
+  rows.resize ( m_h );
+  for ( int r {0}; r<m_h; ++r )
+    {
+      rows[r] = cells.data() + static_cast<std::size_t> ( r ) *m_w;
+    }
+
+  first = reinterpret_cast<const std::uint8_t *> ( mapping->begin() ) + header;
+  end = reinterpret_cast<const std::uint8_t *> ( mapping->end() );
+
+  // the complete frames, a frame being written is cut off
+  const std::uint8_t * q = first;
+  std::uint64_t n;
+
+  while ( q < end && get_varint ( q, end, n ) && n <= static_cast<std::uint64_t> ( end - q ) )
+    {
+      q += n;
+      p = q;
+      ++nofFrames;
+    }
+
+  end = p ? p : first;
+  p = first;
+
+  return nofFrames > 0;
+}
+
+bool SamuReplay::rewind()
+{
+  p = first;
+  std::fill ( cells.begin(), cells.end(), 0 );
+
+  return true;
+}
+
+bool SamuReplay::next()
+{
+  std::uint64_t size;
+
+  if ( p >= end || !get_varint ( p, end, size ) )
+    {
+      return false;
+    }
+
+  const std::uint8_t * q = p;
+  const std::uint8_t * e = p + size;
+  p = e;
+
+  std::uint64_t value;
+
+  if ( !get_varint ( q, e, value ) )
+    {
+      return false;
+    }
+
+  m_tick = unzigzag ( value );
+
+  std::uint64_t n = cells.size();
+  std::uint64_t i {0};
+  int * cell = cells.data();
+
+  while ( i < n )
+    {
+      std::uint64_t skip, run;
+
+      if ( !get_varint ( q, e, skip ) || skip > n - i )
+        {
+          return false;
+        }
+
+      i += skip;
+
+      if ( i == n )
+        {
+          break;
+        }
+
+      if ( !get_varint ( q, e, run ) || run > n - i
+           || ( run+1 ) /2 > static_cast<std::uint64_t> ( e - q ) )
+        {
+          return false;
+        }
+
+      for ( std::uint64_t k {0}; k+1<run; k += 2 )
+        {
+          std::uint8_t b = *q++;
+          cell[i+k] = b & 0x0f;
+          cell[i+k+1] = b >> 4;
+        }
+
+      if ( run & 1 )
+        {
+          cell[i+run-1] = *q++ & 0x0f;
+        }
+
+      i += run;
+    }
+
+  return true;
+}
@@ -0,0 +1,122 @@
+#ifndef SamuFrames_H
+#define SamuFrames_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuFrames.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The recording of the reality that a brain learns from and its replay.
+ * SamuRecorder writes the lattices of the ticks into a file, SamuReplay
+ * reads them back from a read-only memory mapping of the file, so a
+ * stream can be learnt again (by another build of the learner) without
+ * simulating it.
+ *
+ * The file is a header (magic, version, the size of the lattice) and the
+ * frames. A frame is the tick of the reality and its difference from the
+ * previous frame (the first one is compared to an empty lattice): the
+ * cells in row-major order are runs of unchanged cells and runs of changed
+ * cells, the lengths are varints and the new values of the changed cells
+ * are packed into nibbles (the colors are 0..15). A frame is prefixed with
+ * its size, a truncated last frame is ignored.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include "SamuSnapshot.h"
+#include "SamuSource.h"
+
+class SamuRecorder
+{
+public:
+    bool open ( const char * path, int w, int h );
+    // the reality of tick, a color that is not 0..15 makes the file bad
+    bool write ( int ** lattice, long tick );
+    void close();
+
+    bool ok() const {
+        return static_cast<bool> ( file );
+    }
+    // the number of the frames and the bytes of the file
+    std::uint64_t frames() const {
+        return nofFrames;
+    }
+    std::uint64_t bytes() const {
+        return nofBytes;
+    }
+
+private:
+    std::ofstream file;
+    int m_w {0}, m_h {0};
+    // the previous and the current frames and the encoded frame
+    std::vector<std::uint8_t> prev;
+    std::vector<std::uint8_t> cur;
+    std::vector<std::uint8_t> buffer;
+    std::uint64_t nofFrames {0};
+    std::uint64_t nofBytes {0};
+};
+
+class SamuReplay : public SamuSource
+{
+public:
+    bool open ( const char * path );
+
+    int getW() const override {
+        return m_w;
+    }
+    int getH() const override {
+        return m_h;
+    }
+
+    // the next frame is decoded into lattice(), false at the end of the file
+    bool next() override;
+    // from the first frame again
+    bool rewind() override;
+
+    int ** lattice() override {
+        return rows.data();
+    }
+    long tick() const override {
+        return m_tick;
+    }
+    std::uint64_t frames() const {
+        return nofFrames;
+    }
+
+private:
+    std::unique_ptr<SamuMapping> mapping;
+    const std::uint8_t * first {nullptr};
+    const std::uint8_t * p {nullptr};
+    const std::uint8_t * end {nullptr};
+
+    int m_w {0}, m_h {0};
+    std::vector<int> cells;
+    std::vector<int *> rows;
+    long m_tick {0};
+    std::uint64_t nofFrames {0};
+};
+
+#endif
@@ -0,0 +1,477 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuJournal.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The rings of the deltas, the background thread that writes the log and
+ * compacts it, and the recovery.
+ */
+
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "SamuBrain.h"
+#include "SamuJournal.h"
+#include "SamuRing.h"
+
+namespace
+{
+
+const char magic[8] = {'S', 'A', 'M', 'U', 'J', 'R', 'N', 'L'};
+const std::uint32_t version {1};
+
+typedef SamuRing<SamuDelta, 1u << 14> SamuDeltas;
+
+std::atomic<std::uint64_t> lost {0};
+
+bool write_header ( std::ostream & out )
+{
+  std::uint32_t size = sizeof ( SamuDelta );
+
+  out.write ( magic, sizeof ( magic ) );
+  out.write ( reinterpret_cast<const char *> ( &version ), sizeof ( version ) );
+  out.write ( reinterpret_cast<const char *> ( &size ), sizeof ( size ) );
+
+  return static_cast<bool> ( out );
+}
+
+const std::size_t header_size {sizeof ( magic ) + 2*sizeof ( std::uint32_t ) };
+
+}
+
+// the rings of the threads and the thread that writes and applies their deltas
+class SamuJournal::Writer
+{
+public:
+  static Writer & instance()
+  {
+    static Writer writer;
+    return writer;
+  }
+
+  SamuDeltas * add()
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    rings.emplace_back ( new SamuDeltas );
+
+    return rings.back().get();
+  }
+
+  bool open ( const char * base, SamuBrain & brain, long every )
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    finish();
+
+    // the deltas of longer keys would be lost
+    if ( brain.getNeighbourhood().width() > static_cast<int> ( sizeof ( SamuDelta::key ) ) )
+      {
+        return false;
+      }
+
+    base_path = base;
+    log_path = base_path + ".log";
+    compaction = every;
+    compacted = brain.m_internal_clock;
+    sealed = brain.m_internal_clock;
+
+    // the copy of the brain is the base itself
+    shadow.reset ( new SamuBrain ( brain.getW(), brain.getH() ) );
+    if ( !shadow->setNeighbourhood ( brain.getNeighbourhood() )
+         || !brain.save ( base ) || !shadow->restore ( base ) )
+      {
+        shadow.reset();
+        return false;
+      }
+    SamuJournal::index ( *shadow, mpus );
+
+    log.open ( log_path, std::ios::binary | std::ios::trunc );
+    if ( !log || !write_header ( log ) )
+      {
+        shadow.reset();
+        return false;
+      }
+
+    if ( !thread.joinable() )
+      {
+        thread = std::thread ( &Writer::run, this );
+      }
+
+    return true;
+  }
+
+  void seal ( long clock )
+  {
+    sealed.store ( clock, std::memory_order_release );
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    finish();
+  }
+
+  ~Writer()
+  {
+    running = false;
+    if ( thread.joinable() )
+      {
+        thread.join();
+      }
+
+    finish();
+  }
+
+private:
+  void run()
+  {
+    while ( running )
+      {
+        std::size_t n;
+        {
+          std::lock_guard<std::mutex> lock ( mutex );
+          n = drain ( sealed.load ( std::memory_order_acquire ) );
+        }
+
+        if ( !n )
+          {
+            std::this_thread::sleep_for ( std::chrono::milliseconds ( 1 ) );
+          }
+      }
+  }
+
+  // the caller holds the mutex (or it is the last one)
+  void finish()
+  {
+    if ( shadow )
+      {
+        drain ( LONG_MAX );
+        log.close();
+        shadow.reset();
+      }
+    pending.clear();
+  }
+
+  /**
+   * The deltas of the ticks up to clock. It reads clock before the rings,
+   * so all of them have already been pushed. The deltas of a tick come
+   * from several threads, but a QL is updated at most once in a tick, so
+   * ordering them by the ticks is enough.
+   */
+  std::size_t drain ( long clock )
+  {
+    SamuDelta delta;
+
+    for ( std::unique_ptr<SamuDeltas> & ring : rings )
+      while ( ring->pop ( delta ) )
+        {
+          pending.push_back ( delta );
+        }
+
+    if ( !shadow )
+      {
+        pending.clear();
+        return 0;
+      }
+
+    std::stable_sort ( pending.begin(), pending.end(),
+                       [] ( const SamuDelta & a, const SamuDelta & b )
+    {
+      return a.clock < b.clock;
+    } );
+
+    std::vector<SamuDelta>::iterator ready =
+      std::upper_bound ( pending.begin(), pending.end(), clock,
+                         [] ( long c, const SamuDelta & d )
+    {
+      return c < d.clock;
+    } );
+
+    std::size_t n = ready - pending.begin();
+
+    if ( !n )
+      {
+        return 0;
+      }
+
+    log.write ( reinterpret_cast<const char *> ( pending.data() ), n*sizeof ( SamuDelta ) );
+    log.flush();
+
+    for ( std::vector<SamuDelta>::iterator d = pending.begin(); d != ready; ++d )
+      {
+        SamuJournal::apply ( *d, *shadow, mpus );
+      }
+
+    long last = ( ready-1 )->clock;
+    pending.erase ( pending.begin(), ready );
+
+    if ( compaction > 0 && last - compacted >= compaction )
+      {
+        compact ( last );
+      }
+
+    return n;
+  }
+
+  // the copy becomes the new base, the log starts again
+  void compact ( long clock )
+  {
+    std::string tmp = base_path + ".tmp";
+
+    if ( !shadow->save ( tmp.c_str() ) || std::rename ( tmp.c_str(), base_path.c_str() ) )
+      {
+        return;
+      }
+
+    log.close();
+    log.open ( log_path, std::ios::binary | std::ios::trunc );
+    write_header ( log );
+
+    compacted = clock;
+  }
+
+  Writer() = default;
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<SamuDeltas>> rings;
+  std::vector<SamuDelta> pending;
+
+  std::string base_path;
+  std::string log_path;
+  std::ofstream log;
+  long compaction {0};
+  long compacted {0};
+
+  std::unique_ptr<SamuBrain> shadow;
+  std::vector<MentalProcessingUnit *> mpus;
+
+  std::atomic<long> sealed {0};
+  std::atomic<bool> running {true};
+  std::thread thread;
+};
+
+std::atomic<bool> & SamuJournal::journaling()
+{
+  static std::atomic<bool> j {false};
+  return j;
+}
+
+long & SamuJournal::current()
+{
+  static long c {0};
+  return c;
+}
+
+std::uint64_t SamuJournal::dropped()
+{
+  return lost.load();
+}
+
+bool SamuJournal::open ( const char * base, SamuBrain & brain, long compaction )
+{
+  journaling().store ( false, std::memory_order_release );
+
+  bool ok = Writer::instance().open ( base, brain, compaction );
+
+  journaling().store ( ok, std::memory_order_release );
+
+  return ok;
+}
+
+void SamuJournal::close()
+{
+  if ( journaling().exchange ( false ) )
+    {
+      Writer::instance().close();
+    }
+}
+
+void SamuJournal::end ( const SamuBrain & brain )
+{
+  SamuDelta delta = make ( SamuDeltaKind::BRAIN, brain.m_morgan->getId(),
+                           brain.m_haveAlreadyLearntTime, brain.m_searchingStart, std::string() );
+  delta.count = brain.m_maxLearningTime;
+  delta.size = 1;
+  delta.key[0] = brain.m_haveAlreadyLearnt | brain.m_searching << 1 | brain.m_habituation << 2;
+
+  push ( delta );
+
+  Writer::instance().seal ( brain.m_internal_clock );
+}
+
+void SamuJournal::push ( const SamuDelta & delta )
+{
+  static thread_local SamuDeltas * ring = Writer::instance().add();
+
+  if ( delta.size > sizeof ( delta.key ) )
+    {
+      ++lost;
+      return;
+    }
+
+  // the ring is full, waiting for the background thread
+  while ( !ring->push ( delta ) )
+    {
+      std::this_thread::yield();
+    }
+}
+
+void SamuJournal::index ( const SamuBrain & brain, std::vector<MentalProcessingUnit *> & mpus )
+{
+  mpus.clear();
+
+  for ( const auto& mpu : brain.m_brain )
+    {
+      std::size_t id = mpu.second->getId();
+
+      if ( id >= mpus.size() )
+        {
+          mpus.resize ( id+1, nullptr );
+        }
+      mpus[id] = mpu.second;
+    }
+}
+
+bool SamuJournal::apply ( const SamuDelta & delta, SamuBrain & brain, std::vector<MentalProcessingUnit *> & mpus )
+{
+  if ( delta.mpu < 0 || delta.size > sizeof ( delta.key ) )
+    {
+      return false;
+    }
+
+  std::size_t id = delta.mpu;
+  MentalProcessingUnit * morgan = id < mpus.size() ? mpus[id] : nullptr;
+
+  if ( delta.kind == SamuDeltaKind::MPU )
+    {
+      std::string name ( delta.key, delta.size );
+
+      if ( !morgan && brain.m_brain.find ( name ) == brain.m_brain.end() )
+        {
+          morgan = new MentalProcessingUnit ( brain.m_w, brain.m_h, delta.mpu );
+          brain.m_brain[name] = morgan;
+
+          if ( id >= mpus.size() )
+            {
+              mpus.resize ( id+1, nullptr );
+            }
+          mpus[id] = morgan;
+        }
+
+      return true;
+    }
+
+  if ( !morgan )
+    {
+      return false;
+    }
+
+  if ( delta.kind == SamuDeltaKind::BRAIN )
+    {
+      brain.m_internal_clock = delta.clock;
+      brain.m_morgan = morgan;
+      brain.m_haveAlreadyLearntTime = delta.cell;
+      brain.m_searchingStart = delta.triplet;
+      brain.m_maxLearningTime = delta.count;
+      brain.m_haveAlreadyLearnt = delta.key[0] & 1;
+      brain.m_searching = delta.key[0] & 2;
+      brain.m_habituation = delta.key[0] & 4;
+
+      return true;
+    }
+
+  if ( delta.cell < 0 || delta.cell >= brain.m_w*brain.m_h || !morgan->isResident() )
+    {
+      return false;
+    }
+
+  QL & ql = morgan->getSamu() [delta.cell / brain.m_w][delta.cell % brain.m_w];
+  std::string key ( delta.key, delta.size );
+
+  if ( delta.kind == SamuDeltaKind::RULE )
+    {
+      ql.reinforced_action = ReinforcedAction ( key, delta.triplet );
+      ql.rules[ql.reinforced_action] = delta.count;
+
+      return true;
+    }
+
+#ifdef Q_LOOKUP_TABLE
+  if ( delta.kind == SamuDeltaKind::TABLE )
+    {
+      ql.frqs[delta.triplet][key] = delta.count;
+      ql.table_[delta.triplet][key] = delta.value;
+
+      return true;
+    }
+#endif
+
+  return false;
+}
+
+bool SamuJournal::recover ( const char * base, SamuBrain & brain )
+{
+  if ( !brain.restore ( base ) )
+    {
+      return false;
+    }
+
+  std::string log = std::string ( base ) + ".log";
+  SamuMapping mapping ( log.c_str() );
+  const char * p = mapping.begin();
+
+  // without a log the base is the whole state
+  if ( !mapping.ok() || mapping.end() - p < static_cast<std::ptrdiff_t> ( header_size ) )
+    {
+      return true;
+    }
+
+  std::uint32_t v, size;
+  std::memcpy ( &v, p + sizeof ( magic ), sizeof ( v ) );
+  std::memcpy ( &size, p + sizeof ( magic ) + sizeof ( v ), sizeof ( size ) );
+
+  if ( std::memcmp ( p, magic, sizeof ( magic ) ) || v != version || size != sizeof ( SamuDelta ) )
+    {
+      return false;
+    }
+
+  std::vector<MentalProcessingUnit *> mpus;
+  index ( brain, mpus );
+
+  // a delta cut by a crash at the end is left out
+  for ( p += header_size; mapping.end() - p >= static_cast<std::ptrdiff_t> ( sizeof ( SamuDelta ) ); p += sizeof ( SamuDelta ) )
+    {
+      SamuDelta delta;
+      std::memcpy ( &delta, p, sizeof ( delta ) );
+
+      apply ( delta, brain, mpus );
+    }
+
+  return true;
+}
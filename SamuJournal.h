@@ -0,0 +1,155 @@
+#ifndef SamuJournal_H
+#define SamuJournal_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuJournal.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The incremental checkpoints of a brain: a base snapshot (SamuBrain::save)
+ * and an append-only log of the deltas since the base. It is off until
+ * SamuJournal::open is called (headless --journal file).
+ *
+ * While an MPU is learning, each update of its Q table (the new Q value
+ * and the new frequency of the state-action pair) and of its rules is a
+ * fixed size delta put into the ring of the calling thread, as the records
+ * of the monitor stream. The new MPUs and the counters of the brain at the
+ * end of each tick are deltas, too. A background thread appends the deltas
+ * of the finished ticks to the log in the order of the ticks and applies
+ * them to its own copy of the brain, and from time to time it saves that
+ * copy as the new base and starts a new log, so the simulation never
+ * waits for the disk (only for the background thread if a ring is full).
+ *
+ * The deltas hold the new values, not the differences, so replaying a log
+ * onto a base that already has some of them is harmless. The recovery is
+ * the base and its log replayed (SamuJournal::recover).
+ *
+ * Only the Q tables are journaled (Q_LOOKUP_TABLE), the perceptrons of the
+ * NN builds, the habituation and the COP trees are in the base only.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+class SamuBrain;
+class MentalProcessingUnit;
+
+enum class SamuDeltaKind : std::uint8_t {
+    MPU,    // a new MPU: its id and its name in key
+    TABLE,  // Q ( triplet, key ) and its frequency in count
+    RULE,   // the count of the rule ( key, triplet )
+    BRAIN   // the counters of the brain at the end of the tick, see SamuJournal::end
+};
+
+struct SamuDelta {
+    std::int64_t clock;
+    double value;
+    std::int32_t mpu;
+    std::int32_t cell;    // r*w+c
+    std::int32_t triplet;
+    std::int32_t count;
+    SamuDeltaKind kind;
+    std::uint8_t size;    // of key
+    char key[30];
+};
+
+static_assert ( sizeof ( SamuDelta ) == 64, "a delta is a cache line" );
+
+class SamuJournal
+{
+public:
+    // it writes brain into base and the deltas into base.log from now on, a
+    // new base is saved in every compaction ticks, it fails if the keys of
+    // the neighbourhood of brain may be longer than SamuDelta::key
+    static bool open ( const char * base, SamuBrain & brain, long compaction );
+    // it writes the rest of the deltas
+    static void close();
+    // brain is restored from base and base.log
+    static bool recover ( const char * base, SamuBrain & brain );
+
+    static bool on() {
+        return journaling().load ( std::memory_order_acquire );
+    }
+
+    // the deltas that have been lost (a key longer than SamuDelta::key)
+    static std::uint64_t dropped();
+
+    // the ticks of the brain, the deltas between them belong to clock
+    static void begin ( long clock ) {
+        current() = clock;
+    }
+    static void end ( const SamuBrain & brain );
+
+    static void mpu ( int id, const std::string & name ) {
+        SamuDelta delta = make ( SamuDeltaKind::MPU, id, 0, 0, name );
+        push ( delta );
+    }
+
+    static void table ( int mpu, int cell, int triplet, const std::string & state, double q, int frq ) {
+        SamuDelta delta = make ( SamuDeltaKind::TABLE, mpu, cell, triplet, state );
+        delta.value = q;
+        delta.count = frq;
+        push ( delta );
+    }
+
+    static void rule ( int mpu, int cell, const std::pair<std::string, int> & rule, int count ) {
+        SamuDelta delta = make ( SamuDeltaKind::RULE, mpu, cell, rule.second, rule.first );
+        delta.count = count;
+        push ( delta );
+    }
+
+private:
+    static std::atomic<bool> & journaling();
+    static long & current();
+
+    static SamuDelta make ( SamuDeltaKind kind, int mpu, int cell, int triplet, const std::string & key ) {
+        SamuDelta delta;
+        delta.clock = current();
+        delta.value = 0.0;
+        delta.mpu = mpu;
+        delta.cell = cell;
+        delta.triplet = triplet;
+        delta.count = 0;
+        delta.kind = kind;
+        delta.size = key.size() <= sizeof ( delta.key ) ? key.size() : 0xff;
+        std::memcpy ( delta.key, key.data(), std::min ( key.size(), sizeof ( delta.key ) ) );
+
+        return delta;
+    }
+
+    static void push ( const SamuDelta & delta );
+    // mpus: the MPUs of the brain by their ids
+    static bool apply ( const SamuDelta & delta, SamuBrain & brain, std::vector<MentalProcessingUnit *> & mpus );
+    static void index ( const SamuBrain & brain, std::vector<MentalProcessingUnit *> & mpus );
+
+    // the background thread
+    class Writer;
+};
+
+#endif
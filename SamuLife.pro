@@ -1,20 +1,10 @@
-######################################################################
-# Automatically generated by qmake (3.0) P dec. 25 00:29:20 2015
-######################################################################
+# The Qt-free core library (simulation and learning), the Qt GUI, the
+# headless runner and the decoder of the monitor records. The build
+# configuration is in SamuBrain.pri.
 
-DEFINES += LIFEOFGAME
-#DEFINES += SARSA
-DEFINES += Q_LOOKUP_TABLE
+TEMPLATE = subdirs
+SUBDIRS = core gui headless decoder
 
-QT += widgets core
-CONFIG += c++14
-QMAKE_CXXFLAGS += -fopenmp
-LIBS += -fopenmp
-
-TEMPLATE = app
-TARGET = SamuBrain
-INCLUDEPATH += .
-
-# Input
-HEADERS += SamuBrain.h GameOfLife.h SamuLife.h SamuQl.h
-SOURCES +=  main.cpp SamuLife.cpp GameOfLife.cpp SamuBrain.cpp
+gui.depends = core
+headless.depends = core
+decoder.depends = core
@@ -0,0 +1,281 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuLog.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The rings and the background thread of the monitor stream, and the
+ * decoder of the records.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "SamuLog.h"
+#include "SamuRing.h"
+
+namespace
+{
+
+const char magic[8] = {'S', 'A', 'M', 'U', 'L', 'O', 'G', '\0'};
+const std::uint32_t version {1};
+
+typedef SamuRing<SamuRecord, 1u << 14> SamuRecords;
+
+// the rings of the threads and the thread that drains them
+class SamuDrain
+{
+public:
+  static SamuDrain & instance()
+  {
+    static SamuDrain drain;
+    return drain;
+  }
+
+  SamuRecords * add()
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    rings.emplace_back ( new SamuRecords );
+
+    return rings.back().get();
+  }
+
+  bool open ( const char * path )
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    drain();
+
+    file.close();
+    file.open ( path, std::ios::binary | std::ios::trunc );
+
+    return file && SamuLog::write_header ( file );
+  }
+
+  void flush()
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    drain();
+  }
+
+  ~SamuDrain()
+  {
+    running = false;
+    thread.join();
+
+    drain();
+  }
+
+private:
+  SamuDrain() : thread ( &SamuDrain::run, this )
+  {}
+
+  void run()
+  {
+    while ( running )
+      {
+        std::size_t n;
+        {
+          std::lock_guard<std::mutex> lock ( mutex );
+          n = drain();
+        }
+
+        if ( !n )
+          {
+            std::this_thread::sleep_for ( std::chrono::milliseconds ( 1 ) );
+          }
+      }
+  }
+
+  // the caller holds the mutex (or it is the last one)
+  std::size_t drain()
+  {
+    std::size_t n {0};
+    SamuRecord record;
+
+    for ( std::unique_ptr<SamuRecords> & ring : rings )
+      while ( ring->pop ( record ) )
+        {
+          if ( file.is_open() )
+            {
+              file.write ( reinterpret_cast<const char *> ( &record ), sizeof ( record ) );
+            }
+          else
+            {
+              SamuLog::decode ( record, text );
+            }
+          ++n;
+        }
+
+    if ( n )
+      {
+        if ( file.is_open() )
+          {
+            file.flush();
+          }
+        else
+          {
+            std::cerr << text.str();
+            std::cerr.flush();
+            text.str ( "" );
+          }
+      }
+
+    return n;
+  }
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<SamuRecords>> rings;
+  std::ofstream file;
+  std::ostringstream text;
+  std::atomic<bool> running {true};
+  std::thread thread;
+};
+
+}
+
+void SamuLog::push ( const SamuRecord & record )
+{
+  static thread_local SamuRecords * ring = SamuDrain::instance().add();
+
+  // the ring is full, waiting for the background thread
+  while ( !ring->push ( record ) )
+    {
+      std::this_thread::yield();
+    }
+}
+
+bool SamuLog::open ( const char * path )
+{
+  return SamuDrain::instance().open ( path );
+}
+
+void SamuLog::flush()
+{
+  SamuDrain::instance().flush();
+}
+
+bool SamuLog::write_header ( std::ostream & out )
+{
+  std::uint32_t size = sizeof ( SamuRecord );
+
+  out.write ( magic, sizeof ( magic ) );
+  out.write ( reinterpret_cast<const char *> ( &version ), sizeof ( version ) );
+  out.write ( reinterpret_cast<const char *> ( &size ), sizeof ( size ) );
+
+  return static_cast<bool> ( out );
+}
+
+bool SamuLog::read_header ( std::istream & in )
+{
+  char m[sizeof ( magic )];
+  std::uint32_t v, size;
+
+  in.read ( m, sizeof ( m ) );
+  in.read ( reinterpret_cast<char *> ( &v ), sizeof ( v ) );
+  in.read ( reinterpret_cast<char *> ( &size ), sizeof ( size ) );
+
+  return in
+         && !std::memcmp ( m, magic, sizeof ( magic ) )
+         && v == version
+         && size == sizeof ( SamuRecord );
+}
+
+void SamuLog::decode ( const SamuRecord & record, std::ostream & out )
+{
+  switch ( record.event )
+    {
+    case SamuEvent::TICK_BEGIN:
+      out << "<<< " << record.clock << " <<<";
+      break;
+    case SamuEvent::TICK_END:
+      out << ">>> " << record.clock << " >>>";
+      break;
+    case SamuEvent::OBSERVATION:
+      out << record.clock
+          << "    #MPUs: " << record.n
+          << " Observation (MPU): " << record.mpu;
+      break;
+    case SamuEvent::IS_HABITUATION:
+      out << "   HABITUATION MONITOR: (isHABI MPU)";
+      for ( int i {0}; i<6; ++i )
+        {
+          out << ' ' << record.sums[i];
+        }
+      break;
+    case SamuEvent::SEARCHING:
+      out << "   HABITUATION MONITOR: " << record.clock
+          << " [SEARCHING] MPU: " << record.mpu
+          << " bogocertainty of convergence: " << record.mon << " %";
+      break;
+    case SamuEvent::LEARNING:
+    case SamuEvent::LEARNED:
+      out << "   HABITUATION MONITOR: " << record.clock
+          << ( record.event == SamuEvent::LEARNING ? " [LEARNING] " : " [LEARNED] " ) << record.mpu
+          << " bogocertainty of convergence: " << record.mon << " %";
+      break;
+    case SamuEvent::NEW_MPU:
+    case SamuEvent::RECOGNIZED_MPU:
+      out << "   SENSITIZATION MONITOR: " << record.clock
+          << " MPU-notion: " << record.mpu
+          << ( record.event == SamuEvent::NEW_MPU ? " (new MPU, searching time) "
+               : " (recognized MPU, searching time) " )
+          << record.n;
+      break;
+    case SamuEvent::NEW_INPUT:
+      out << "   SENSITIZATION MONITOR: " << record.clock
+          << " (new input detected)";
+      break;
+    case SamuEvent::LEARNING_TIME:
+      out << "   HIGHER-ORDER NOTION MONITOR: " << record.clock
+          << " MPU-notion: " << record.mpu
+          << " (learning time) " << record.n;
+      break;
+    case SamuEvent::MEMORY:
+      out << "   MEMORY MONITOR: " << record.clock
+          << " MPU: " << record.mpu
+          << " bytes: " << static_cast<std::uint64_t> ( record.mon );
+      break;
+    case SamuEvent::MEMORY_BYTES:
+    case SamuEvent::MEMORY_ENTRIES:
+      out << "   MEMORY MONITOR: " << record.clock
+          << ( record.event == SamuEvent::MEMORY_BYTES ? " (bytes)" : " (entries)" )
+          << " table: " << record.sizes[0]
+          << " frqs: " << record.sizes[1]
+          << " rules: " << record.sizes[2]
+          << " tree: " << record.sizes[3]
+          << " perceptrons: " << record.sizes[4];
+      break;
+    default:
+      out << "   UNKNOWN RECORD: " << static_cast<int> ( record.event );
+    }
+
+  out << '\n';
+}
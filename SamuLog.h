@@ -0,0 +1,203 @@
+#ifndef SamuLog_H
+#define SamuLog_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuLog.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The monitor stream of SamuBrain without Qt and without formatting on
+ * the hot path. A monitor line is a fixed size binary record that is put
+ * into the (lock-free, single producer, single consumer) ring of the
+ * calling thread. A background thread drains the rings, it writes the
+ * records into a file (SamuLog::open) or, by default, decodes them into
+ * the usual monitor text on the standard error:
+ *
+ *    HABITUATION MONITOR: 77 [LEARNING] Foobar0 0x... bogocertainty of convergence: 0 %
+ *
+ * The records of a file can be decoded offline by SamuLogDecode into the
+ * same text. Each monitor has its own level, a record is dropped before it
+ * is made if the level of its monitor is lower than the level of it.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+enum class SamuMonitor : std::uint8_t {
+    TICK,
+    HABITUATION,
+    SENSITIZATION,
+    HIGHER_ORDER,
+    MEMORY,
+    NOF_MONITORS
+};
+
+enum class SamuEvent : std::uint16_t {
+    TICK_BEGIN,       // <<< t <<<
+    TICK_END,         // >>> t >>>
+    OBSERVATION,      // t #MPUs: n Observation (MPU): mpu
+    IS_HABITUATION,   // HABITUATION MONITOR: (isHABI MPU) sums
+    SEARCHING,        // HABITUATION MONITOR: t [SEARCHING] MPU: mpu ...
+    LEARNING,         // HABITUATION MONITOR: t [LEARNING] mpu ...
+    LEARNED,          // HABITUATION MONITOR: t [LEARNED] mpu ...
+    NEW_MPU,          // SENSITIZATION MONITOR: t MPU-notion: mpu (new MPU, ...
+    RECOGNIZED_MPU,   // SENSITIZATION MONITOR: t MPU-notion: mpu (recognized MPU, ...
+    NEW_INPUT,        // SENSITIZATION MONITOR: t (new input detected)
+    LEARNING_TIME,    // HIGHER-ORDER NOTION MONITOR: t MPU-notion: mpu (learning time) n
+    MEMORY,           // MEMORY MONITOR: t MPU: mpu bytes: total
+    MEMORY_BYTES,     // MEMORY MONITOR: t (bytes) table: ... perceptrons: ...
+    MEMORY_ENTRIES,   // MEMORY MONITOR: t (entries) table: ... perceptrons: ...
+    NOF_EVENTS
+};
+
+// 0: off, 1: the notions (and the state changes), 2: each tick, 3: each MPU in each tick
+struct SamuLevel {
+    static constexpr int OFF {0};
+    static constexpr int NOTION {1};
+    static constexpr int TICK {2};
+    static constexpr int MPU {3};
+};
+
+struct SamuRecord {
+    std::int64_t clock;
+    double mon;
+    std::int32_t n;
+    SamuEvent event;
+    union {
+        char mpu[40];
+        std::int32_t sums[6];
+        std::uint64_t sizes[5];
+    };
+};
+
+static_assert ( sizeof ( SamuRecord ) == 64, "a record is a cache line" );
+
+class SamuLog
+{
+public:
+    static int & level ( SamuMonitor monitor ) {
+        static int levels[static_cast<int> ( SamuMonitor::NOF_MONITORS )] {
+            SamuLevel::TICK, SamuLevel::MPU, SamuLevel::NOTION, SamuLevel::NOTION, SamuLevel::NOTION
+        };
+        return levels[static_cast<int> ( monitor )];
+    }
+
+    static void setLevel ( int l ) {
+        for ( int m {0}; m < static_cast<int> ( SamuMonitor::NOF_MONITORS ); ++m ) {
+            level ( static_cast<SamuMonitor> ( m ) ) = l;
+        }
+    }
+
+    static bool enabled ( SamuEvent event ) {
+        return level ( monitor ( event ) ) >= eventLevel ( event );
+    }
+
+    static void log ( SamuEvent event, long clock, const std::string & mpu = std::string(),
+                      double mon = 0.0, int n = 0 ) {
+        if ( !enabled ( event ) ) {
+            return;
+        }
+
+        SamuRecord record;
+        record.clock = clock;
+        record.mon = mon;
+        record.n = n;
+        record.event = event;
+        std::strncpy ( record.mpu, mpu.c_str(), sizeof ( record.mpu ) - 1 );
+        record.mpu[sizeof ( record.mpu ) - 1] = '\0';
+
+        push ( record );
+    }
+
+    // the parts of SamuMemory
+    static void log ( SamuEvent event, long clock, const std::uint64_t sizes[5] ) {
+        if ( !enabled ( event ) ) {
+            return;
+        }
+
+        SamuRecord record;
+        record.clock = clock;
+        record.mon = 0.0;
+        record.n = 0;
+        record.event = event;
+        std::memcpy ( record.sizes, sizes, sizeof ( record.sizes ) );
+
+        push ( record );
+    }
+
+    static void log ( SamuEvent event, const int sums[6] ) {
+        if ( !enabled ( event ) ) {
+            return;
+        }
+
+        SamuRecord record;
+        record.clock = 0;
+        record.mon = 0.0;
+        record.n = 0;
+        record.event = event;
+        std::memcpy ( record.sums, sums, sizeof ( record.sums ) );
+
+        push ( record );
+    }
+
+    // the records are written into this file instead of the standard error
+    static bool open ( const char * path );
+    // it drains the rings, the rest of the records are written at exit anyway
+    static void flush();
+
+    static bool write_header ( std::ostream & out );
+    static bool read_header ( std::istream & in );
+    static void decode ( const SamuRecord & record, std::ostream & out );
+
+    static SamuMonitor monitor ( SamuEvent event ) {
+        static const SamuMonitor monitors[static_cast<int> ( SamuEvent::NOF_EVENTS )] {
+            SamuMonitor::TICK, SamuMonitor::TICK, SamuMonitor::TICK,
+            SamuMonitor::HABITUATION, SamuMonitor::HABITUATION,
+            SamuMonitor::HABITUATION, SamuMonitor::HABITUATION,
+            SamuMonitor::SENSITIZATION, SamuMonitor::SENSITIZATION, SamuMonitor::SENSITIZATION,
+            SamuMonitor::HIGHER_ORDER,
+            SamuMonitor::MEMORY, SamuMonitor::MEMORY, SamuMonitor::MEMORY
+        };
+        return monitors[static_cast<int> ( event )];
+    }
+
+    static int eventLevel ( SamuEvent event ) {
+        static const int levels[static_cast<int> ( SamuEvent::NOF_EVENTS )] {
+            SamuLevel::TICK, SamuLevel::TICK, SamuLevel::TICK,
+            SamuLevel::MPU, SamuLevel::MPU, SamuLevel::TICK, SamuLevel::TICK,
+            SamuLevel::NOTION, SamuLevel::NOTION, SamuLevel::NOTION,
+            SamuLevel::NOTION,
+            SamuLevel::NOTION, SamuLevel::NOTION, SamuLevel::NOTION
+        };
+        return levels[static_cast<int> ( event )];
+    }
+
+private:
+    static void push ( const SamuRecord & record );
+};
+
+#endif
@@ -0,0 +1,218 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuNeighbourhood.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The prefix sums and the sliding histograms of the neighbourhoods.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include "SamuNeighbourhood.h"
+
+namespace
+{
+
+int digits ( int n )
+{
+  int d {1};
+
+  for ( ; n >= 10; n /= 10 )
+    {
+      ++d;
+    }
+
+  return d;
+}
+
+}
+
+int SamuNeighbourhood::width() const
+{
+  // a state is an int
+  return 11 + m_colors * ( 1 + digits ( size() ) );
+}
+
+void SamuNeighbourhood::prepare ( int ** reality, int w, int h )
+{
+  int R = m_radius;
+  int k = m_colors;
+
+  if ( m_W != w+2*R || m_H != h+2*R )
+    {
+      m_W = w+2*R;
+      m_H = h+2*R;
+
+      // the first row and the first (last) column of the (anti)diagonal
+      // sums are zeros, they are never written
+      std::size_t n = at ( m_H+1, 0 );
+      columns.assign ( n, 0 );
+      diagonals.assign ( n, 0 );
+      antidiagonals.assign ( n, 0 );
+
+      rowOf.resize ( m_H );
+      for ( int y {0}; y<m_H; ++y )
+        {
+          rowOf[y] = ( ( y-R ) % h + h ) % h;
+        }
+      columnOf.resize ( m_W );
+      for ( int x {0}; x<m_W; ++x )
+        {
+          columnOf[x] = ( ( x-R ) % w + w ) % w;
+        }
+    }
+
+  for ( int y {0}; y<m_H; ++y )
+    {
+      const int * row = reality[rowOf[y]];
+
+      for ( int x {0}; x<m_W; ++x )
+        {
+          int color = row[columnOf[x]];
+
+          const std::int32_t * up = &columns[at ( y, x )];
+          const std::int32_t * upLeft = &diagonals[at ( y, x )];
+          const std::int32_t * upRight = &antidiagonals[at ( y, x+1 )];
+
+          std::int32_t * column = &columns[at ( y+1, x )];
+          std::int32_t * diagonal = &diagonals[at ( y+1, x+1 )];
+          std::int32_t * antidiagonal = &antidiagonals[at ( y+1, x )];
+
+          for ( int ci {0}; ci<k; ++ci )
+            {
+              int in = color == ci;
+
+              column[ci] = up[ci] + in;
+              diagonal[ci] = upLeft[ci] + in;
+              antidiagonal[ci] = upRight[ci] + in;
+            }
+        }
+    }
+}
+
+void SamuNeighbourhood::column ( int y0, int y1, int x, int sign, int window[] ) const
+{
+  const std::int32_t * top = &columns[at ( y0, x )];
+  const std::int32_t * bottom = &columns[at ( y1+1, x )];
+
+  for ( int ci {0}; ci<m_colors; ++ci )
+    {
+      window[ci] += sign * ( bottom[ci] - top[ci] );
+    }
+}
+
+void SamuNeighbourhood::diagonal ( int y, int x, int n, int sign, int window[] ) const
+{
+  const std::int32_t * top = &diagonals[at ( y, x )];
+  const std::int32_t * bottom = &diagonals[at ( y+n, x+n )];
+
+  for ( int ci {0}; ci<m_colors; ++ci )
+    {
+      window[ci] += sign * ( bottom[ci] - top[ci] );
+    }
+}
+
+void SamuNeighbourhood::antidiagonal ( int y, int x, int n, int sign, int window[] ) const
+{
+  const std::int32_t * top = &antidiagonals[at ( y, x+1 )];
+  const std::int32_t * bottom = &antidiagonals[at ( y+n, x-n+1 )];
+
+  for ( int ci {0}; ci<m_colors; ++ci )
+    {
+      window[ci] += sign * ( bottom[ci] - top[ci] );
+    }
+}
+
+void SamuNeighbourhood::first ( int r, int window[] ) const
+{
+  int R = m_radius;
+
+  std::fill ( window, window + m_colors, 0 );
+
+  // the padded cell ( r+R, R ) is the cell ( r, 0 )
+  for ( int dx {-R}; dx<=R; ++dx )
+    {
+      int dy = m_shape == SamuShape::MOORE ? R : R - std::abs ( dx );
+      column ( r+R-dy, r+R+dy, R+dx, 1, window );
+    }
+}
+
+void SamuNeighbourhood::slide ( int r, int c, int window[] ) const
+{
+  int R = m_radius;
+  int Y = r+R;
+  int X = c+R;
+
+  if ( m_shape == SamuShape::MOORE )
+    {
+      column ( Y-R, Y+R, X+R+1, 1, window );
+      column ( Y-R, Y+R, X-R, -1, window );
+    }
+  else
+    {
+      // the right edges of the new diamond and the left edges of the old one
+      diagonal ( Y-R, X+1, R+1, 1, window );
+      antidiagonal ( Y+1, X+R, R, 1, window );
+      antidiagonal ( Y-R, X, R+1, -1, window );
+      diagonal ( Y+1, X-R+1, R, -1, window );
+    }
+}
+
+int SamuNeighbourhood::key ( char * out, int state, const int neighbours[] ) const
+{
+  char * p = out;
+  char digit[12];
+
+  // the digits are written backwards, then they are copied
+  auto put = [&] ( int n ) {
+    unsigned u = n < 0 ? -static_cast<unsigned> ( n ) : n;
+    int d {0};
+
+    do
+      {
+        digit[d++] = '0' + u % 10;
+        u /= 10;
+      }
+    while ( u );
+
+    if ( n < 0 )
+      {
+        *p++ = '-';
+      }
+    while ( d )
+      {
+        *p++ = digit[--d];
+      }
+  };
+
+  put ( state );
+
+  for ( int ci {0}; ci<m_colors; ++ci )
+    {
+      *p++ = '|';
+      put ( neighbours[ci] );
+    }
+
+  return p - out;
+}
@@ -0,0 +1,128 @@
+#ifndef SamuNeighbourhood_H
+#define SamuNeighbourhood_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuNeighbourhood.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The neighbourhood of a cell in the keys of the cells (SamuBrain::encoding):
+ * the Moore (square) or the von Neumann (diamond) neighbourhood of radius r
+ * on the torus, and the alphabet of the colors that are counted in it. The
+ * key of a cell is its color and the number of its neighbours of each color
+ * ("s|n0|n1|...", the paper uses the Moore neighbourhood of radius 1 and 5
+ * colors), so its width follows the alphabet and the neighbourhood.
+ *
+ * The histograms of the neighbourhoods slide along the rows: the histogram
+ * of the next cell is that of the cell plus the cells entering on its right
+ * minus the cells leaving on its left. The entering and leaving cells are
+ * columns (Moore) or diagonals (von Neumann) of the lattice, their counts
+ * are differences of prefix sums along the columns and the diagonals of
+ * the reality (prepare), so a cell costs the same for any radius.
+ */
+
+#include <cstdint>
+#include <vector>
+
+enum class SamuShape : std::uint8_t {
+    MOORE,
+    VON_NEUMANN
+};
+
+class SamuNeighbourhood
+{
+public:
+    static const int max_colors {16};
+    static const int max_radius {64};
+    // the longest key of the largest neighbourhood and alphabet
+    static const int max_key {128};
+
+    SamuNeighbourhood ( SamuShape shape = SamuShape::MOORE, int radius = 1, int colors = 5 )
+        : m_shape ( shape ), m_radius ( radius ), m_colors ( colors )
+    {}
+
+    bool valid() const {
+        return 1 <= m_radius && m_radius <= max_radius && 1 <= m_colors && m_colors <= max_colors;
+    }
+    bool operator== ( const SamuNeighbourhood & other ) const {
+        return m_shape == other.m_shape && m_radius == other.m_radius && m_colors == other.m_colors;
+    }
+
+    SamuShape shape() const {
+        return m_shape;
+    }
+    int radius() const {
+        return m_radius;
+    }
+    int colors() const {
+        return m_colors;
+    }
+    // the number of the neighbours of a cell
+    int size() const {
+        return m_shape == SamuShape::MOORE
+               ? ( 2*m_radius+1 ) * ( 2*m_radius+1 ) - 1
+               : 2*m_radius * ( m_radius+1 );
+    }
+    // the longest key of a cell
+    int width() const;
+
+    // the prefix sums of the colors of reality
+    void prepare ( int ** reality, int w, int h );
+
+    // window is the histogram of the neighbourhood of the cell ( r, 0 )
+    // with the cell itself, slide moves it from ( r, c ) to ( r, c+1 )
+    void first ( int r, int window[] ) const;
+    void slide ( int r, int c, int window[] ) const;
+
+    // the key of a cell of color state and of the histogram of its
+    // neighbours into out (at least width() long), it returns its length
+    int key ( char * out, int state, const int neighbours[] ) const;
+
+private:
+    // the entry of the color 0 of the padded cell ( y, x ) in the sums
+    std::size_t at ( int y, int x ) const {
+        return ( static_cast<std::size_t> ( y ) * ( m_W+1 ) + x ) * m_colors;
+    }
+
+    // the sums of a column from the row y0 to the row y1 (inclusive), and
+    // of n cells of a diagonal (down right) or of an antidiagonal (down
+    // left) from ( y, x ), they are added to window with sign
+    void column ( int y0, int y1, int x, int sign, int window[] ) const;
+    void diagonal ( int y, int x, int n, int sign, int window[] ) const;
+    void antidiagonal ( int y, int x, int n, int sign, int window[] ) const;
+
+    SamuShape m_shape;
+    int m_radius;
+    int m_colors;
+
+    // the reality padded with radius wrapped cells on each side
+    int m_W {0}, m_H {0};
+    std::vector<int> rowOf;
+    std::vector<int> columnOf;
+    std::vector<std::int32_t> columns;
+    std::vector<std::int32_t> diagonals;
+    std::vector<std::int32_t> antidiagonals;
+};
+
+#endif
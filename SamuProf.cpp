@@ -0,0 +1,209 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuProf.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The histograms of the threads and their dump.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "SamuProf.h"
+#include "SamuTrace.h"
+
+namespace
+{
+
+const int nof_phases {static_cast<int> ( SamuPhase::NOF_PHASES ) };
+
+struct SamuHistograms {
+  SamuHistogram phases[nof_phases];
+};
+
+class SamuProfiler
+{
+public:
+  static SamuProfiler & instance()
+  {
+    static SamuProfiler profiler;
+    return profiler;
+  }
+
+  SamuHistograms * add()
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    threads.emplace_back ( new SamuHistograms );
+
+    return threads.back().get();
+  }
+
+  void dump ( std::ostream & out )
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    out << std::left << std::setw ( 14 ) << "phase" << std::right
+        << std::setw ( 12 ) << "count"
+        << std::setw ( 12 ) << "mean us"
+        << std::setw ( 12 ) << "p50 us"
+        << std::setw ( 12 ) << "p99 us"
+        << std::setw ( 12 ) << "max us" << '\n';
+
+    for ( int p {0}; p<nof_phases; ++p )
+      {
+        std::vector<std::uint64_t> counts ( SamuHistogram::nof_buckets );
+        std::uint64_t n {0}, sum {0}, max {0};
+
+        for ( std::unique_ptr<SamuHistograms> & thread : threads )
+          {
+            SamuHistogram & h = thread->phases[p];
+
+            for ( int b {0}; b<SamuHistogram::nof_buckets; ++b )
+              {
+                counts[b] += h.counts[b].load ( std::memory_order_relaxed );
+              }
+            n += h.n.load ( std::memory_order_relaxed );
+            sum += h.sum.load ( std::memory_order_relaxed );
+            max = std::max ( max, h.max.load ( std::memory_order_relaxed ) );
+          }
+
+        if ( !n )
+          {
+            continue;
+          }
+
+        out << std::left << std::setw ( 14 ) << SamuProf::name ( static_cast<SamuPhase> ( p ) ) << std::right
+            << std::setw ( 12 ) << n
+            << std::fixed << std::setprecision ( 2 )
+            << std::setw ( 12 ) << sum / 1000.0 / n
+            << std::setw ( 12 ) << percentile ( counts, .5 ) / 1000.0
+            << std::setw ( 12 ) << percentile ( counts, .99 ) / 1000.0
+            << std::setw ( 12 ) << max / 1000.0 << '\n';
+        out.unsetf ( std::ios::fixed );
+      }
+  }
+
+  ~SamuProfiler()
+  {
+#ifdef SAMU_PROFILE
+    dump ( std::cerr );
+#endif
+  }
+
+private:
+  static std::uint64_t percentile ( const std::vector<std::uint64_t> & counts, double p )
+  {
+    std::uint64_t n {0};
+
+    for ( std::uint64_t c : counts )
+      {
+        n += c;
+      }
+
+    std::uint64_t rank = p * n, seen {0};
+
+    for ( int b {0}; b<SamuHistogram::nof_buckets; ++b )
+      {
+        seen += counts[b];
+
+        if ( seen > rank )
+          {
+            return SamuHistogram::upper ( b );
+          }
+      }
+
+    return 0;
+  }
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<SamuHistograms>> threads;
+};
+
+}
+
+void SamuProf::record ( SamuPhase phase, std::uint64_t ns )
+{
+  static thread_local SamuHistograms * histograms = SamuProfiler::instance().add();
+
+  histograms->phases[static_cast<int> ( phase )].record ( ns );
+}
+
+void SamuProf::record ( SamuPhase phase,
+                        std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point end )
+{
+#ifdef SAMU_PROFILE
+  std::chrono::nanoseconds d = end - start;
+  record ( phase, d.count() );
+#endif
+
+  SamuTrace::span ( phase, start, end );
+}
+
+void SamuProf::dump ( std::ostream & out )
+{
+#ifdef SAMU_PROFILE
+  SamuProfiler::instance().dump ( out );
+#else
+  out << "The phases are not timed, build with DEFINES += SAMU_PROFILE.\n";
+#endif
+}
+
+namespace
+{
+thread_local SamuPhase current_phase {SamuPhase::NOF_PHASES};
+}
+
+SamuPhase SamuProf::current()
+{
+  return current_phase;
+}
+
+SamuPhase SamuProf::enter ( SamuPhase phase )
+{
+  SamuPhase previous = current_phase;
+  current_phase = phase;
+
+  return previous;
+}
+
+void SamuProf::leave ( SamuPhase previous )
+{
+  current_phase = previous;
+}
+
+const char * SamuProf::name ( SamuPhase phase )
+{
+  static const char * names[nof_phases] =
+  {
+    "tick", "development", "learning", "search", "pred",
+    "encoding", "QL", "habituation", "emit", "paint"
+  };
+
+  return names[static_cast<int> ( phase )];
+}
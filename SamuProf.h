@@ -0,0 +1,230 @@
+#ifndef SamuProf_H
+#define SamuProf_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuProf.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The timing of the phases of a tick. With DEFINES += SAMU_PROFILE a
+ * SAMU_PHASE ( PRED ); statement starts a timer that stops at the end of
+ * its scope and records the elapsed time into the histogram of the phase,
+ * without SAMU_PROFILE the statement is empty.
+ *
+ * The histograms are HDR-style (log-linear, the relative error of a
+ * percentile is below 1/16), each thread has its own ones, so recording
+ * is two loads and two stores. SamuProf::dump writes the count, mean,
+ * p50, p99 and max of each phase, it can be called at any time and it
+ * is called at exit.
+ *
+ * With DEFINES += SAMU_TRACE the phases are timed only for the timeline
+ * of SamuTrace (without the histograms), the phases of the cells
+ * (SAMU_CELL_PHASE) are timed only with SAMU_PROFILE and only in a random
+ * sample of the cells (one in SamuCellTimer::sample), so the counts of
+ * ENCODING and QL are those of the sampled cells.
+ *
+ * With DEFINES += SAMU_ALLOC a timer also sets the phase of its thread
+ * (SamuProf::current), the heap allocations are counted per phase, see
+ * SamuAlloc.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+enum class SamuPhase : std::uint8_t {
+    TICK,         // GameOfLife::step
+    DEVELOPMENT,  // GameOfLife::development
+    LEARNING,     // SamuBrain::learning
+    SEARCH,       // the MPU search loop of SamuBrain::learning
+    PRED,         // SamuBrain::pred
+    ENCODING,     // the neighbourhood and the key of a cell in pred
+    QL,           // QL::operator() of a cell in pred
+    HABITUATION,  // Habituation::is_habituation
+    EMIT,         // the signal of the GUI thread
+    PAINT,        // SamuLife::paintEvent
+    NOF_PHASES
+};
+
+class SamuHistogram
+{
+public:
+    static constexpr int sub_bits {4};
+    static constexpr int sub_buckets {1 << sub_bits};
+    static constexpr int nof_buckets {64*sub_buckets};
+
+    // it is called only by the owner thread, the others may read it meanwhile
+    void record ( std::uint64_t ns ) {
+        bump ( counts[bucket ( ns )], 1 );
+        bump ( n, 1 );
+        bump ( sum, ns );
+        if ( ns > max.load ( std::memory_order_relaxed ) ) {
+            max.store ( ns, std::memory_order_relaxed );
+        }
+    }
+
+    static int bucket ( std::uint64_t ns ) {
+        if ( ns < sub_buckets ) {
+            return ns;
+        }
+        int e = 63 - __builtin_clzll ( ns );
+        return ( e-sub_bits+1 ) *sub_buckets + ( ( ns >> ( e-sub_bits ) ) & ( sub_buckets-1 ) );
+    }
+
+    // the largest value of a bucket
+    static std::uint64_t upper ( int b ) {
+        if ( b < sub_buckets ) {
+            return b;
+        }
+        int e = b / sub_buckets + sub_bits - 1;
+        std::uint64_t low = ( std::uint64_t ( sub_buckets + b % sub_buckets ) ) << ( e-sub_bits );
+        return low + ( std::uint64_t ( 1 ) << ( e-sub_bits ) ) - 1;
+    }
+
+    std::atomic<std::uint64_t> counts[nof_buckets] {};
+    std::atomic<std::uint64_t> n {0};
+    std::atomic<std::uint64_t> sum {0};
+    std::atomic<std::uint64_t> max {0};
+
+private:
+    static void bump ( std::atomic<std::uint64_t> & a, std::uint64_t d ) {
+        a.store ( a.load ( std::memory_order_relaxed ) + d, std::memory_order_relaxed );
+    }
+};
+
+class SamuProf
+{
+public:
+    static void record ( SamuPhase phase, std::uint64_t ns );
+    // the histogram (SAMU_PROFILE) and the span of the trace (if it is on)
+    static void record ( SamuPhase phase,
+                         std::chrono::steady_clock::time_point start,
+                         std::chrono::steady_clock::time_point end );
+    static void dump ( std::ostream & out );
+    static const char * name ( SamuPhase phase );
+
+    // the innermost phase of the calling thread (NOF_PHASES: none), SAMU_ALLOC
+    static SamuPhase current();
+    static SamuPhase enter ( SamuPhase phase );
+    static void leave ( SamuPhase previous );
+};
+
+class SamuTimer
+{
+public:
+    explicit SamuTimer ( SamuPhase phase ) : phase ( phase ),
+#ifdef SAMU_ALLOC
+        previous ( SamuProf::enter ( phase ) ),
+#endif
+        start ( std::chrono::steady_clock::now() )
+    {}
+
+    ~SamuTimer() {
+        SamuProf::record ( phase, start, std::chrono::steady_clock::now() );
+#ifdef SAMU_ALLOC
+        SamuProf::leave ( previous );
+#endif
+    }
+
+private:
+    SamuTimer ( const SamuTimer & );
+    SamuTimer & operator= ( const SamuTimer & );
+
+    SamuPhase phase;
+#ifdef SAMU_ALLOC
+    SamuPhase previous;
+#endif
+    std::chrono::steady_clock::time_point start;
+};
+
+// the phase of a cell, two clock reads in every cell would cost as much as
+// the encoding itself (the sample is random, every n-th timer would always
+// hit the same phase of the cells)
+class SamuCellTimer
+{
+public:
+    static constexpr std::uint32_t sample {16};
+
+    explicit SamuCellTimer ( SamuPhase phase ) : phase ( phase ),
+#ifdef SAMU_ALLOC
+        previous ( SamuProf::enter ( phase ) ),
+#endif
+        timed ( sampled() )
+    {
+#ifdef SAMU_PROFILE
+        if ( timed ) {
+            start = std::chrono::steady_clock::now();
+        }
+#endif
+    }
+
+    ~SamuCellTimer() {
+#ifdef SAMU_PROFILE
+        if ( timed ) {
+            SamuProf::record ( phase, start, std::chrono::steady_clock::now() );
+        }
+#endif
+#ifdef SAMU_ALLOC
+        SamuProf::leave ( previous );
+#endif
+    }
+
+private:
+    // xorshift32 of the calling thread
+    static bool sampled() {
+        static thread_local std::uint32_t x {2463534242u};
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return ( x & ( sample-1 ) ) == 0;
+    }
+
+    SamuCellTimer ( const SamuCellTimer & );
+    SamuCellTimer & operator= ( const SamuCellTimer & );
+
+    SamuPhase phase;
+#ifdef SAMU_ALLOC
+    SamuPhase previous;
+#endif
+    bool timed;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define SAMU_CONCAT_( a, b ) a ## b
+#define SAMU_CONCAT( a, b ) SAMU_CONCAT_( a, b )
+
+#if defined ( SAMU_PROFILE ) || defined ( SAMU_TRACE ) || defined ( SAMU_ALLOC )
+#define SAMU_PHASE( phase ) SamuTimer SAMU_CONCAT( samu_timer_, __LINE__ ) ( SamuPhase::phase )
+#else
+#define SAMU_PHASE( phase )
+#endif
+
+#if defined ( SAMU_PROFILE ) || defined ( SAMU_ALLOC )
+#define SAMU_CELL_PHASE( phase ) SamuCellTimer SAMU_CONCAT( samu_timer_, __LINE__ ) ( SamuPhase::phase )
+#else
+#define SAMU_CELL_PHASE( phase )
+#endif
+
+#endif
@@ -57,8 +57,153 @@
 #include <limits>
 #include <fstream>
 #include <cstring>
+#include <vector>
+#include <type_traits>
+#include <algorithm>
+#include "SamuJournal.h"
+#include "SamuSnapshot.h"
 
-class Perceptron
+/**
+ * The logistic function of the perceptrons.
+ *
+ * The fast variant is the Lambert continued fraction (a 7/6 rational
+ * function) of tanh evaluated at x/2 clamped to [-4.79, 4.79], so that
+ * |approx ( x ) - exact ( x )| < 3.7e-5 for every x. It has neither branches
+ * nor library calls, so the loops over the units of a layer vectorize.
+ * It is the default with FAST_SIGMOID and it can be switched on or off at
+ * run time with Sigmoid::fast().
+ */
+class Sigmoid
+{
+public:
+    static bool & fast() {
+#ifdef FAST_SIGMOID
+        static bool fast {true};
+#else
+        static bool fast {false};
+#endif
+        return fast;
+    }
+
+    static double exact ( double x ) {
+        return 1.0/ ( 1.0 + exp ( -x ) );
+    }
+
+    static double approx ( double x ) {
+        double t = std::min ( std::max ( .5*x, -4.79 ), 4.79 );
+        double t2 = t*t;
+        double p = t* ( 135135.0 + t2* ( 17325.0 + t2* ( 378.0 + t2 ) ) );
+        double q = 135135.0 + t2* ( 62370.0 + t2* ( 3150.0 + t2*28.0 ) );
+
+        return .5 + .5*p/q;
+    }
+
+    static double apply ( double x ) {
+        return fast() ? approx ( x ) : exact ( x );
+    }
+
+    // in place, over the units of a whole layer
+    static void apply ( double x [], int n ) {
+        if ( fast() ) {
+            #pragma omp simd
+            for ( int i = 0; i < n; ++i ) {
+                x[i] = approx ( x[i] );
+            }
+        } else {
+            for ( int i = 0; i < n; ++i ) {
+                x[i] = exact ( x[i] );
+            }
+        }
+    }
+
+    // sigmoid ( x ) * ( 1.0-sigmoid ( x ) ) with one evaluation
+    static double derivative ( double x ) {
+        double s = apply ( x );
+
+        return s * ( 1.0-s );
+    }
+};
+
+/**
+ * The indices of the non-zero values of an input image.
+ *
+ * The images derived from the lattices are mostly zeros. If the density
+ * of an input is below density(), the first layer of a perceptron uses
+ * only the non-zero inputs both in the dot products and in the weight
+ * updates. The skipped terms are exact zeros, so the results are the same
+ * as the ones of the dense kernels. Small inputs are always dense.
+ */
+class SparseInput
+{
+public:
+    static constexpr int min_inputs {64};
+
+    static double & density() {
+        static double density {.25};
+        return density;
+    }
+
+    // the scratch of the calling thread
+    static SparseInput & local() {
+        static thread_local SparseInput sparse;
+        return sparse;
+    }
+
+    // true if the image is sparse, then its non-zero indices are collected
+    bool scan ( const double * image, int n ) {
+        if ( n < min_inputs ) {
+            return false;
+        }
+
+        if ( ( int ) nz.size() < n ) {
+            nz.resize ( n );
+        }
+
+        int limit = n*density();
+        n_nz = 0;
+
+        for ( int k = 0; k < n; ++k ) {
+            if ( image[k] != 0.0 ) {
+                if ( n_nz == limit ) {
+                    return false;
+                }
+
+                nz[n_nz++] = k;
+            }
+        }
+
+        return true;
+    }
+
+    double dot ( const double * w, const double * x ) const {
+        double z = 0.0;
+
+        for ( int i = 0; i < n_nz; ++i ) {
+            z += w[nz[i]] * x[nz[i]];
+        }
+
+        return z;
+    }
+
+    void update ( double * w, double delta, const double * x ) const {
+        for ( int i = 0; i < n_nz; ++i ) {
+            w[nz[i]] += ( delta * x[nz[i]] );
+        }
+    }
+
+private:
+    std::vector<int> nz;
+    int n_nz {0};
+};
+
+template <int... Layers>
+class Perceptron;
+
+/**
+ * The runtime-sized perceptron, Perceptron<> ( 3, 2, 6, 1 ) is a 2-6-1 network.
+ */
+template <>
+class Perceptron<>
 {
 public:
     Perceptron ( int nof, ... ) {
@@ -136,7 +281,7 @@ public:
 
 
     double sigmoid ( double x ) {
-        return 1.0/ ( 1.0 + exp ( -x ) );
+        return Sigmoid::apply ( x );
     }
 
 
@@ -144,6 +289,9 @@ public:
 
         units[0] = image;
 
+        SparseInput & sparse = SparseInput::local();
+        bool is_sparse = sparse.scan ( image, n_units[0] );
+
         for ( int i {1}; i < n_layers; ++i ) {
 
 #ifdef CUDA_PRCPS
@@ -154,16 +302,22 @@ public:
 
             #pragma omp parallel for
             for ( int j = 0; j < n_units[i]; ++j ) {
+
+                if ( i == 1 && is_sparse ) {
+                    units[i][j] = sparse.dot ( weights[i-1][j], image );
+                    continue;
+                }
+
                 units[i][j] = 0.0;
 
                 for ( int k = 0; k < n_units[i-1]; ++k ) {
                     units[i][j] += weights[i-1][j][k] * units[i-1][k];
                 }
 
-                units[i][j] = sigmoid ( units[i][j] );
-
             }
 
+            Sigmoid::apply ( units[i], n_units[i] );
+
 #endif
 
         }
@@ -183,6 +337,9 @@ public:
 
         units[0] = image;
 
+        SparseInput & sparse = SparseInput::local();
+        bool is_sparse = sparse.scan ( image, n_units[0] );
+
         double ** backs = new double*[n_layers-1];
 
         for ( int i {0}; i < n_layers-1; ++i ) {
@@ -192,7 +349,12 @@ public:
         int i {n_layers-1};
 
         for ( int j {0}; j < n_units[i]; ++j ) {
-            backs[i-1][j] = sigmoid ( units[i][j] ) * ( 1.0-sigmoid ( units[i][j] ) ) * ( y[j] - units[i][j] );
+            backs[i-1][j] = Sigmoid::derivative ( units[i][j] ) * ( y[j] - units[i][j] );
+
+            if ( i == 1 && is_sparse ) {
+                sparse.update ( weights[i-1][j], 0.2* backs[i-1][j], image );
+                continue;
+            }
 
             for ( int k {0}; k < n_units[i-1]; ++k ) {
                 weights[i-1][j][k] += ( 0.2* backs[i-1][j] *units[i-1][k] );
@@ -211,7 +373,12 @@ public:
                     sum += 0.19*weights[i][l][j]*backs[i][l];
                 }
 
-                backs[i-1][j] = sigmoid ( units[i][j] ) * ( 1.0-sigmoid ( units[i][j] ) ) * sum;
+                backs[i-1][j] = Sigmoid::derivative ( units[i][j] ) * sum;
+
+                if ( i == 1 && is_sparse ) {
+                    sparse.update ( weights[i-1][j], 0.19* backs[i-1][j], image );
+                    continue;
+                }
 
                 for ( int k = 0; k < n_units[i-1]; ++k ) {
                     weights[i-1][j][k] += ( 0.19* backs[i-1][j] *units[i-1][k] );
@@ -249,43 +416,777 @@ public:
 
     }
 
-    void save ( std::fstream & out ) {
-        out << " "
-            << n_layers;
+    std::size_t n_weights() const {
+        std::size_t n {0};
+
+        for ( int i {1}; i < n_layers; ++i ) {
+            n += n_units[i]*n_units[i-1];
+        }
+
+        return n;
+    }
+
+    // the object and its arrays
+    std::size_t bytes() const {
+        std::size_t n = sizeof ( *this ) + n_layers* ( sizeof ( int ) + sizeof ( double * ) )
+                        + ( n_layers-1 ) *sizeof ( double ** );
+
+        for ( int i {1}; i < n_layers; ++i ) {
+            n += n_units[i]* ( sizeof ( double ) + sizeof ( double * ) );
+        }
+
+        return n + n_weights() *sizeof ( double );
+    }
+
+    void save ( std::fstream & out ) {
+        out << " "
+            << n_layers;
+
+        for ( int i {0}; i < n_layers; ++i ) {
+            out << " " << n_units[i];
+        }
+
+        for ( int i {1}; i < n_layers; ++i ) {
+            for ( int j {0}; j < n_units[i]; ++j ) {
+                for ( int k {0}; k < n_units[i-1]; ++k ) {
+                    out << " "
+                        << weights[i-1][j][k];
+
+                }
+            }
+        }
+
+    }
+
+private:
+    Perceptron ( const Perceptron & );
+    Perceptron & operator= ( const Perceptron & );
+
+    int n_layers;
+    int* n_units;
+    double **units;
+    double ***weights;
+
+};
+
+
+constexpr int perceptron_units ( const int * n_units, int from, int to )
+{
+    return from < to ? n_units[from] + perceptron_units ( n_units, from+1, to ) : 0;
+}
+
+constexpr int perceptron_weights ( const int * n_units, int from, int to )
+{
+    return from < to ? n_units[from]*n_units[from-1] + perceptron_weights ( n_units, from+1, to ) : 0;
+}
+
+/**
+ * The compile-time sized perceptron, Perceptron<2, 6, 1> is a 2-6-1 network.
+ *
+ * The layer sizes are constant expressions, so the loops of the kernels
+ * have fixed trip counts and the compiler can unroll them. The weights
+ * and the activations are stored in the object itself and the deltas of
+ * the backpropagation live on the stack. It computes exactly what
+ * Perceptron<> does with the same topology.
+ */
+template <int... Layers>
+class Perceptron
+{
+public:
+    static constexpr int n_layers = sizeof... ( Layers );
+    static constexpr int n_units[n_layers] = {Layers...};
+
+    Perceptron ( ) {
+
+#ifndef RND_DEBUG
+        std::random_device init;
+        std::default_random_engine gen {init() };
+#else
+        std::default_random_engine gen;
+#endif
+
+        std::uniform_real_distribution<double> dist ( -1.0, 1.0 );
+
+        for ( double & w : weights ) {
+            w = dist ( gen );
+        }
+    }
+
+    double sigmoid ( double x ) {
+        return Sigmoid::apply ( x );
+    }
+
+    double operator() ( double image [] ) {
+
+        input = image;
+        scan ( image );
+
+        forward ( std::integral_constant<int, 1>() );
+
+        return sigmoid ( units[unit_offset ( n_layers-1 )] );
+    }
+
+    void learning ( double image [], double q, double ) {
+        double y[1] {q};
+
+        learning ( image, y );
+    }
+
+    void learning ( double image [], double y[] ) {
+
+        input = image;
+        scan ( image );
+
+        double backs[perceptron_units ( n_units, 1, n_layers )];
+
+        constexpr int i {n_layers-1};
+        constexpr int n_in {n_units[i-1]};
+
+        double * u = units + unit_offset ( i );
+        double * back = backs + unit_offset ( i );
+        double * w = weights + weight_offset ( i );
+        const double * prev = layer ( i-1 );
+
+        for ( int j {0}; j < n_units[i]; ++j ) {
+            back[j] = Sigmoid::derivative ( u[j] ) * ( y[j] - u[j] );
+
+            update<i> ( w + j*n_in, 0.2* back[j], prev );
+        }
+
+        backward ( backs, std::integral_constant<int, n_layers-2>() );
+    }
+
+    static constexpr std::size_t n_weights() {
+        return perceptron_weights ( n_units, 1, n_layers );
+    }
+
+    std::size_t bytes() const {
+        return sizeof ( *this );
+    }
+
+    // the weights, the activations are recomputed by the next call
+    void save ( SamuWriter & out ) const {
+        out.put ( weights, n_weights() );
+    }
+
+    bool restore ( SamuReader & in ) {
+        return in.get ( weights, n_weights() );
+    }
+
+private:
+    Perceptron ( const Perceptron & );
+    Perceptron & operator= ( const Perceptron & );
+
+    static constexpr int unit_offset ( int i ) {
+        return perceptron_units ( n_units, 1, i );
+    }
+
+    static constexpr int weight_offset ( int i ) {
+        return perceptron_weights ( n_units, 1, i );
+    }
+
+    double * layer ( int i ) {
+        return i ? units + unit_offset ( i ) : input;
+    }
+
+    void forward ( std::integral_constant<int, n_layers> ) {
+    }
+
+    template <int I>
+    void forward ( std::integral_constant<int, I> ) {
+
+        constexpr int n_in {n_units[I-1]};
+        constexpr int n_out {n_units[I]};
+
+        const double * prev = layer ( I-1 );
+        const double * w = weights + weight_offset ( I );
+        double * u = units + unit_offset ( I );
+
+        if ( n_in*n_out > omp_limit ) {
+            #pragma omp parallel for
+            for ( int j = 0; j < n_out; ++j ) {
+                u[j] = dot<I> ( w + j*n_in, prev );
+            }
+        } else {
+            for ( int j = 0; j < n_out; ++j ) {
+                u[j] = dot<I> ( w + j*n_in, prev );
+            }
+        }
+
+        Sigmoid::apply ( u, n_out );
+
+        forward ( std::integral_constant<int, I+1>() );
+    }
+
+    // the kernels of the layer I
+    void scan ( const double * image ) {
+        SparseInput & local = SparseInput::local();
+        sparse = ( sparse_input && local.scan ( image, n_units[0] ) ) ? &local : nullptr;
+    }
+
+    template <int I>
+    double dot ( const double * w, const double * x ) const {
+        if ( I == 1 && sparse ) {
+            return sparse->dot ( w, x );
+        }
+
+        double z = 0.0;
+
+        for ( int k = 0; k < n_units[I-1]; ++k ) {
+            z += w[k] * x[k];
+        }
+
+        return z;
+    }
+
+    template <int I>
+    void update ( double * w, double delta, const double * x ) const {
+        if ( I == 1 && sparse ) {
+            sparse->update ( w, delta, x );
+            return;
+        }
+
+        for ( int k = 0; k < n_units[I-1]; ++k ) {
+            w[k] += ( delta *x[k] );
+        }
+    }
+
+    void backward ( double [], std::integral_constant<int, 0> ) {
+    }
+
+    template <int I>
+    void backward ( double backs [], std::integral_constant<int, I> ) {
+
+        constexpr int n_in {n_units[I-1]};
+        constexpr int n_out {n_units[I]};
+        constexpr int n_next {n_units[I+1]};
+
+        const double * prev = layer ( I-1 );
+        const double * u = units + unit_offset ( I );
+        const double * next_w = weights + weight_offset ( I+1 );
+        const double * next_back = backs + unit_offset ( I+1 );
+        double * w = weights + weight_offset ( I );
+        double * back = backs + unit_offset ( I );
+
+        auto unit = [&] ( int j ) {
+
+            double sum = 0.0;
+
+            for ( int l = 0; l < n_next; ++l ) {
+                sum += 0.19*next_w[l*n_out+j]*next_back[l];
+            }
+
+            back[j] = Sigmoid::derivative ( u[j] ) * sum;
+
+            update<I> ( w + j*n_in, 0.19* back[j], prev );
+        };
+
+        if ( n_in*n_out > omp_limit ) {
+            #pragma omp parallel for
+            for ( int j = 0; j < n_out; ++j ) {
+                unit ( j );
+            }
+        } else {
+            for ( int j = 0; j < n_out; ++j ) {
+                unit ( j );
+            }
+        }
+
+        backward ( backs, std::integral_constant<int, I-1>() );
+    }
+
+    // smaller layers are not worth a parallel region
+    static constexpr int omp_limit {4096};
+    static constexpr bool sparse_input {n_units[0] >= SparseInput::min_inputs};
+
+    double * input {nullptr};
+    // the non-zero inputs of a sparse image, the scratch of the calling thread
+    const SparseInput * sparse {nullptr};
+    double units[perceptron_units ( n_units, 1, n_layers )];
+    double weights[perceptron_weights ( n_units, 1, n_layers )];
+
+};
+
+template <int... Layers>
+constexpr int Perceptron<Layers...>::n_units[];
+
+/**
+ * Double-buffered input images of the perceptrons of an MPU.
+ *
+ * A QL does not copy its input, it keeps only a pointer to the image of
+ * its previous call. Each call of next() flips the two planes, so an
+ * image stays intact until the next but one call. This is exactly what
+ * a QL needs, provided that every image of a plane is passed to its QL
+ * before next() is called again. The images can be private to the cells
+ * or one image can be shared by all of them, then the memory does not
+ * depend on the number of cells.
+ */
+class FrameStore
+{
+public:
+    FrameStore ( int n_images, int n_inputs ) : n_inputs ( n_inputs ) {
+        planes[0].assign ( n_images*n_inputs, 0.0 );
+        planes[1].assign ( n_images*n_inputs, 0.0 );
+    }
+
+    double * next() {
+        current = 1-current;
+
+        return planes[current].data();
+    }
+
+    double * image ( int i ) {
+        return planes[current].data() + i*n_inputs;
+    }
+
+    int inputs() const {
+        return n_inputs;
+    }
+
+    std::size_t bytes() const {
+        return sizeof ( *this ) + ( planes[0].capacity() + planes[1].capacity() ) *sizeof ( double );
+    }
+
+    // an image of a plane as a position in the two planes, -1 if it is not here
+    std::int64_t offset ( const double * image ) const {
+        for ( int p {0}; p < 2; ++p )
+            if ( !planes[p].empty() && image >= planes[p].data() && image < planes[p].data() + planes[p].size() ) {
+                return p*planes[0].size() + ( image - planes[p].data() );
+            }
+
+        return -1;
+    }
+
+    double * at ( std::int64_t offset ) {
+        if ( offset < 0 || offset >= static_cast<std::int64_t> ( 2*planes[0].size() ) ) {
+            return nullptr;
+        }
+
+        return planes[offset / planes[0].size()].data() + offset % planes[0].size();
+    }
+
+    void save ( SamuWriter & out ) const {
+        out.put ( current );
+        out.put ( planes[0] );
+        out.put ( planes[1] );
+    }
+
+    bool restore ( SamuReader & in ) {
+        std::size_t size {planes[0].size() };
+
+        in.get ( current );
+        in.get ( planes[0] );
+        in.get ( planes[1] );
+
+        return in.ok() && ( current == 0 || current == 1 )
+               && planes[0].size() == size && planes[1].size() == size;
+    }
+
+private:
+    FrameStore ( const FrameStore & );
+    FrameStore & operator= ( const FrameStore & );
+
+    int n_inputs;
+    int current {0};
+    std::vector<double> planes[2];
+};
+
+#ifdef FEELINGS
+typedef std::string Feeling;
+#endif
+
+typedef int SPOTriplet;
+typedef std::pair<std::string, SPOTriplet> ReinforcedAction;
+
+#ifdef PLACE_VALUE
+//typedef Perceptron<10*3, 4, 1> QlPerceptron; //exp.a1 // 302
+typedef Perceptron<10*3, 16, 8, 4, 1> QlPerceptron;
+#elif FOUR_TIMES
+typedef Perceptron<2*10*2*80, 32, 1> QlPerceptron;
+#elif CHARACTER_CONSOLE
+typedef Perceptron<10*80, 32, 1> QlPerceptron; //exp.a1 // 302
+//typedef Perceptron<10*80, 64, 1> QlPerceptron; //exp.a4
+//typedef Perceptron<10*80, 256, 32, 1> QlPerceptron;
+//typedef Perceptron<10*80, 256, 128, 32, 1> QlPerceptron; // 355
+//typedef Perceptron<10*80, 196, 32, 32, 1> QlPerceptron; // 302
+//typedef Perceptron<10*80, 400, 400, 32, 1> QlPerceptron; // 302
+#elif LIFEOFGAME
+//typedef Perceptron<9, 32, 1> QlPerceptron;
+//typedef Perceptron<2, 64, 9, 1> QlPerceptron;
+typedef Perceptron<2, 6, 1> QlPerceptron;
+#else
+typedef Perceptron<256*256, 80, 1> QlPerceptron;
+//typedef Perceptron<256*256, 400, 1> QlPerceptron;
+#endif
+
+/**
+ * One shared trunk (input and hidden layers) with one output head per action.
+ *
+ * The trunk is evaluated once per image, after that every Q(s', a') costs
+ * only a single dot product over the last hidden layer. Heads are added
+ * on the fly when a new triplet appears. The output and learning rules
+ * are the same as the ones of the Perceptron above.
+ */
+class MultiHeadPerceptron
+{
+public:
+    MultiHeadPerceptron ( int nof, ... ) : n_layers ( nof ) {
+        va_list vap;
+
+        va_start ( vap, nof );
+
+        for ( int i {0}; i < n_layers; ++i ) {
+            n_units.push_back ( va_arg ( vap, int ) );
+        }
+
+        va_end ( vap );
+
+        units.resize ( n_layers );
+        weights.resize ( n_layers-1 );
+
+        for ( int i {1}; i < n_layers; ++i ) {
+            units[i].resize ( n_units[i] );
+            weights[i-1].resize ( n_units[i]*n_units[i-1] );
+
+            for ( double & w : weights[i-1] ) {
+                w = dist ( gen );
+            }
+        }
+    }
+
+    bool has ( SPOTriplet triplet ) const {
+        return heads_.find ( triplet ) != heads_.end();
+    }
+
+    void add ( SPOTriplet triplet ) {
+        int n_top = n_units[n_layers-1];
+
+        heads_[triplet] = q.size();
+
+        for ( int k {0}; k < n_top; ++k ) {
+            head_weights.push_back ( dist ( gen ) );
+        }
+
+        head_units.push_back ( 0.0 );
+        q.push_back ( 0.0 );
+    }
+
+    const std::map<SPOTriplet, int> & heads() const {
+        return heads_;
+    }
+
+    // all Q(s', a') values with one pass, indexed by heads()
+    const std::vector<double> & operator() ( double image [] ) {
+
+        trunk ( image );
+
+        int n_top = n_units[n_layers-1];
+        const double * top = units[n_layers-1].data();
+
+        for ( int h = 0; h < ( int ) q.size(); ++h ) {
+            q[h] = head ( h, top, n_top );
+        }
+
+        return q;
+    }
+
+    double operator() ( double image [], SPOTriplet triplet ) {
+
+        trunk ( image );
+
+        int h = heads_[triplet];
+
+        return q[h] = head ( h, units[n_layers-1].data(), n_units[n_layers-1] );
+    }
+
+    // it assumes that the previous call was operator() ( image, triplet )
+    void learning ( double image [], SPOTriplet triplet, double y ) {
+
+        int h = heads_[triplet];
+        int n_top = n_units[n_layers-1];
+        double * w = &head_weights[h*n_top];
+        double u = head_units[h];
+
+        SparseInput & sparse = SparseInput::local();
+        bool is_sparse = sparse.scan ( image, n_units[0] );
+
+        backs.resize ( n_layers );
+        backs[n_layers-1].assign ( 1, Sigmoid::derivative ( u ) * ( y - u ) );
+
+        for ( int k {0}; k < n_top; ++k ) {
+            w[k] += ( 0.2* backs[n_layers-1][0] *units[n_layers-1][k] );
+        }
+
+        for ( int i {n_layers-1}; i >0 ; --i ) {
+
+            backs[i-1].resize ( n_units[i] );
+
+            const double * prev = ( i == 1 ) ? image : units[i-1].data();
+            double * wi = weights[i-1].data();
+            int n_in = n_units[i-1];
+            int n_out = n_units[i];
+
+            auto unit = [&] ( int j ) {
+
+                double sum = 0.0;
+
+                if ( i == n_layers-1 ) {
+                    sum = 0.19*w[j]*backs[i][0];
+                } else {
+                    for ( int l = 0; l < n_units[i+1]; ++l ) {
+                        sum += 0.19*weights[i][l*n_out+j]*backs[i][l];
+                    }
+                }
+
+                backs[i-1][j] = Sigmoid::derivative ( units[i][j] ) * sum;
+
+                if ( i == 1 && is_sparse ) {
+                    sparse.update ( wi + j*n_in, 0.19* backs[i-1][j], prev );
+                    return;
+                }
+
+                for ( int k = 0; k < n_in; ++k ) {
+                    wi[j*n_in+k] += ( 0.19* backs[i-1][j] *prev[k] );
+                }
+            };
+
+            if ( n_in*n_out > omp_limit ) {
+                #pragma omp parallel for
+                for ( int j = 0; j < n_out; ++j ) {
+                    unit ( j );
+                }
+            } else {
+                for ( int j = 0; j < n_out; ++j ) {
+                    unit ( j );
+                }
+            }
+        }
+    }
+
+    std::size_t n_weights() const {
+        std::size_t n {head_weights.size() };
+
+        for ( const std::vector<double> & w : weights ) {
+            n += w.size();
+        }
+
+        return n;
+    }
+
+    // the weights and the heads, the activations are recomputed by the next call
+    void save ( SamuWriter & out ) const {
+        for ( const std::vector<double> & w : weights ) {
+            out.put ( w );
+        }
+        out.put ( heads_ );
+        out.put ( head_weights );
+    }
+
+    bool restore ( SamuReader & in ) {
+        for ( std::vector<double> & w : weights ) {
+            std::size_t size {w.size() };
+
+            if ( !in.get ( w ) || w.size() != size ) {
+                return false;
+            }
+        }
+        in.get ( heads_ );
+        in.get ( head_weights );
+
+        head_units.assign ( heads_.size(), 0.0 );
+        q.assign ( heads_.size(), 0.0 );
+
+        return in.ok() && head_weights.size() == heads_.size() *n_units[n_layers-1];
+    }
+
+    // the object, its vectors and the nodes of the map of the heads
+    std::size_t bytes() const {
+        std::size_t n = sizeof ( *this ) + n_units.capacity() *sizeof ( int )
+                        + ( head_weights.capacity() + head_units.capacity() + q.capacity() ) *sizeof ( double )
+                        + heads_.size() * ( 4*sizeof ( void * ) + sizeof ( std::pair<const SPOTriplet, int> ) );
+
+        for ( const std::vector<std::vector<double>> * layers : {&units, &weights, &backs} ) {
+            for ( const std::vector<double> & v : *layers ) {
+                n += sizeof ( v ) + v.capacity() *sizeof ( double );
+            }
+        }
+
+        return n;
+    }
+
+private:
+    MultiHeadPerceptron ( const MultiHeadPerceptron & );
+    MultiHeadPerceptron & operator= ( const MultiHeadPerceptron & );
+
+    void trunk ( double image [] ) {
+
+        SparseInput & sparse = SparseInput::local();
+        bool is_sparse = sparse.scan ( image, n_units[0] );
+
+        for ( int i {1}; i < n_layers; ++i ) {
+
+            const double * prev = ( i == 1 ) ? image : units[i-1].data();
+            const double * wi = weights[i-1].data();
+            int n_in = n_units[i-1];
+            int n_out = n_units[i];
+
+            double * u = units[i].data();
+
+            auto unit = [&] ( int j ) {
+
+                if ( i == 1 && is_sparse ) {
+                    u[j] = sparse.dot ( wi + j*n_in, prev );
+                    return;
+                }
+
+                double z = 0.0;
+
+                for ( int k = 0; k < n_in; ++k ) {
+                    z += wi[j*n_in+k] * prev[k];
+                }
+
+                u[j] = z;
+            };
+
+            if ( n_in*n_out > omp_limit ) {
+                #pragma omp parallel for
+                for ( int j = 0; j < n_out; ++j ) {
+                    unit ( j );
+                }
+            } else {
+                for ( int j = 0; j < n_out; ++j ) {
+                    unit ( j );
+                }
+            }
+
+            Sigmoid::apply ( u, n_out );
+        }
+    }
+
+    double head ( int h, const double * top, int n_top ) {
+        const double * w = &head_weights[h*n_top];
+        double z = 0.0;
+
+        for ( int k {0}; k < n_top; ++k ) {
+            z += w[k] * top[k];
+        }
+
+        head_units[h] = Sigmoid::apply ( z );
+
+        return Sigmoid::apply ( head_units[h] );
+    }
+
+    static constexpr int omp_limit {4096};
+
+    int n_layers;
+    std::vector<int> n_units;
+    std::vector<std::vector<double>> units;
+    std::vector<std::vector<double>> weights;
+    std::vector<std::vector<double>> backs;
+
+    std::map<SPOTriplet, int> heads_;
+    std::vector<double> head_weights;
+    std::vector<double> head_units;
+    std::vector<double> q;
+
+#ifndef RND_DEBUG
+    std::random_device init;
+    std::default_random_engine gen {init() };
+#else
+    std::default_random_engine gen;
+#endif
+    std::uniform_real_distribution<double> dist {-1.0, 1.0};
+};
+
+/**
+ * The memory of the learning structures of a QL, or the sum of them for
+ * an MPU or for the whole brain: the bytes and the number of entries of
+ * the Q table, of the frequencies, of the rules, of the LZW tree and of
+ * the perceptrons (their weights). The bytes are estimated from the sizes
+ * of the nodes of the containers (the overhead of the allocator is not
+ * included), the rest (the QL objects, the lattices of the MPUs, the
+ * images) is in other.
+ */
+struct SamuMemory {
+    enum Part {TABLE, FRQS, RULES, TREE, PERCEPTRONS, NOF_PARTS};
+
+    std::size_t bytes[NOF_PARTS] {};
+    std::size_t entries[NOF_PARTS] {};
+    std::size_t other {0};
+
+    std::size_t total() const {
+        std::size_t n {other};
+
+        for ( int p {0}; p < NOF_PARTS; ++p ) {
+            n += bytes[p];
+        }
+
+        return n;
+    }
+
+    SamuMemory & operator+= ( const SamuMemory & m ) {
+        for ( int p {0}; p < NOF_PARTS; ++p ) {
+            bytes[p] += m.bytes[p];
+            entries[p] += m.entries[p];
+        }
+        other += m.other;
+
+        return *this;
+    }
+
+    template <typename K, typename V>
+    void add ( Part part, const std::map<K, V> & m ) {
+        bytes[part] += heap ( m );
+        entries[part] += leaves ( m );
+    }
+
+    // a node of a std::map: three links, the color and the value
+    template <typename K, typename V>
+    static std::size_t node ( const std::map<K, V> & ) {
+        return 4*sizeof ( void * ) + sizeof ( std::pair<const K, V> );
+    }
+
+    template <typename T>
+    static std::size_t heap ( const T & ) {
+        return 0;
+    }
+
+    static std::size_t heap ( const std::string & s ) {
+        return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+    }
 
-        for ( int i {0}; i < n_layers; ++i ) {
-            out << " " << n_units[i];
-        }
+    template <typename T, typename U>
+    static std::size_t heap ( const std::pair<T, U> & p ) {
+        return heap ( p.first ) + heap ( p.second );
+    }
 
-        for ( int i {1}; i < n_layers; ++i ) {
-            for ( int j {0}; j < n_units[i]; ++j ) {
-                for ( int k {0}; k < n_units[i-1]; ++k ) {
-                    out << " "
-                        << weights[i-1][j][k];
+    template <typename K, typename V>
+    static std::size_t heap ( const std::map<K, V> & m ) {
+        std::size_t n {m.size() *node ( m ) };
 
-                }
-            }
+        for ( const std::pair<const K, V> & e : m ) {
+            n += heap ( e.first ) + heap ( e.second );
         }
 
+        return n;
     }
 
-private:
-    Perceptron ( const Perceptron & );
-    Perceptron & operator= ( const Perceptron & );
-
-    int n_layers;
-    int* n_units;
-    double **units;
-    double ***weights;
+    template <typename T>
+    static std::size_t leaves ( const T & ) {
+        return 1;
+    }
 
-};
+    template <typename K, typename V>
+    static std::size_t leaves ( const std::map<K, V> & m ) {
+        std::size_t n {0};
 
-#ifdef FEELINGS
-typedef std::string Feeling;
-#endif
+        for ( const std::pair<const K, V> & e : m ) {
+            n += leaves ( e.second );
+        }
 
-typedef int SPOTriplet;
-typedef std::pair<std::string, SPOTriplet> ReinforcedAction;
+        return n;
+    }
+};
 
 class QL
 {
@@ -307,7 +1208,7 @@ public:
                   //ss << c;
                   ss << dist ( gen );
               }
-              prcps_f[ss.str()] = new Perceptron ( 3, 10*80, 16,  1 ); //exp.a1 // 302
+              prcps_f[ss.str()] = new Perceptron<> ( 3, 10*80, 16,  1 ); //exp.a1 // 302
           }
     #endif
       }
@@ -317,17 +1218,21 @@ public:
       QL ( SPOTriplet triplet )
       {}
       */
-    QL ( )
+    QL ( ) :tree ( &root )
     {}
 
     ~QL() {
 #ifndef Q_LOOKUP_TABLE
-        for ( std::map<SPOTriplet, Perceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
+#ifdef SHARED_TRUNK
+        delete trunk;
+#else
+        for ( std::map<SPOTriplet, QlPerceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
             delete it->second;
         }
 #endif
+#endif
 #ifdef FEELINGS
-        for ( std::map<Feeling, Perceptron*>::iterator it=prcps_f.begin(); it!=prcps_f.end(); ++it ) {
+        for ( std::map<Feeling, Perceptron<>*>::iterator it=prcps_f.begin(); it!=prcps_f.end(); ++it ) {
             delete it->second;
         }
 #endif
@@ -363,9 +1268,17 @@ public:
         double q_spap;
         double min_q_spap = -std::numeric_limits<double>::max();
 
-        for ( std::map<SPOTriplet, Perceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
+#ifdef SHARED_TRUNK
+        const std::vector<double> & q = ( *trunk ) ( image );
+
+        for ( std::vector<double>::const_iterator it=q.begin(); it!=q.end(); ++it ) {
+
+            q_spap = *it;
+#else
+        for ( std::map<SPOTriplet, QlPerceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
 
             q_spap = ( * ( it->second ) ) ( image );
+#endif
             if ( q_spap > min_q_spap ) {
                 min_q_spap = q_spap;
             }
@@ -383,6 +1296,14 @@ public:
 
         int rN = children.size();
 
+#ifdef SHARED_TRUNK
+        if ( !rN ) {
+            return max_ap_Q_sp_ap ( image );
+        }
+
+        const std::vector<double> & q = ( *trunk ) ( image );
+#endif
+
         //std::uniform_int_distribution<int> zdist ( 0, rN+1+rN/10 );
         //std::uniform_int_distribution<int> zdist ( 0, 100 );
         //if ( zdist ( zgen ) < rN )
@@ -390,20 +1311,26 @@ public:
         if ( rN )
             for ( std::map<SPOTriplet, TripletNode*>::iterator it=children.begin(); it!=children.end(); ++it ) {
 
+#ifdef SHARED_TRUNK
+                q_spap = q[trunk->heads().at ( it->first )];
+#else
                 q_spap = ( * ( prcps[it->first] ) ) ( image );
+#endif
                 if ( q_spap > min_q_spap ) {
                     min_q_spap = q_spap;
                 }
             }
 
+#ifndef SHARED_TRUNK
         else
-            for ( std::map<SPOTriplet, Perceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
+            for ( std::map<SPOTriplet, QlPerceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
 
                 q_spap = ( * ( it->second ) ) ( image );
                 if ( q_spap > min_q_spap ) {
                     min_q_spap = q_spap;
                 }
             }
+#endif
 
         return min_q_spap;
     }
@@ -414,7 +1341,7 @@ public:
         double q_spap;
         double min_q_spap = -std::numeric_limits<double>::max();
 
-        for ( std::map<Feeling, Perceptron*>::iterator it=prcps_f.begin(); it!=prcps_f.end(); ++it ) {
+        for ( std::map<Feeling, Perceptron<>*>::iterator it=prcps_f.begin(); it!=prcps_f.end(); ++it ) {
 
             q_spap = ( * ( it->second ) ) ( image );
             if ( q_spap > min_q_spap ) {
@@ -440,6 +1367,14 @@ public:
 
         int rN = children.size();
 
+#ifdef SHARED_TRUNK
+        if ( !rN ) {
+            return argmax_ap_f ( prg, image );
+        }
+
+        const std::vector<double> & q = ( *trunk ) ( image );
+#endif
+
         //std::uniform_int_distribution<int> zdist ( 0, rN+1+rN/10 );
         //std::uniform_int_distribution<int> zdist ( 0, 100 );
         //if ( zdist ( zgen ) < rN )
@@ -447,11 +1382,15 @@ public:
         if ( rN ) {
             for ( std::map<SPOTriplet, TripletNode*>::iterator it=children.begin(); it!=children.end(); ++it ) {
                 /*
-                    for ( std::map<SPOTriplet, Perceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it )
+                    for ( std::map<SPOTriplet, QlPerceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it )
                       {
                 */
                 //double  q_spap = ( * ( it->second ) ) ( image );
+#ifdef SHARED_TRUNK
+                double  q_spap = q[trunk->heads().at ( it->first )];
+#else
                 double  q_spap = ( * ( prcps[it->first] ) ) ( image );
+#endif
                 double explor = f ( q_spap, frqs[it->first][prg] );
 
 #ifdef QNN_DEBUG_BREL
@@ -483,8 +1422,10 @@ public:
             }
 #endif
 
-        } else {
-            for ( std::map<SPOTriplet, Perceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
+        }
+#ifndef SHARED_TRUNK
+        else {
+            for ( std::map<SPOTriplet, QlPerceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
                 double  q_spap = ( * ( it->second ) ) ( image );
                 double explor = f ( q_spap, frqs[it->first][prg] );
 
@@ -514,6 +1455,7 @@ public:
 #endif
 
         }
+#endif
 
 
         return ap;
@@ -529,9 +1471,17 @@ public:
         double a = std::numeric_limits<double>::max(), b = -std::numeric_limits<double>::max();
 #endif
 
-        for ( std::map<SPOTriplet, Perceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
+#ifdef SHARED_TRUNK
+        const std::vector<double> & q = ( *trunk ) ( image );
+
+        for ( std::map<SPOTriplet, int>::const_iterator it=trunk->heads().begin(); it!=trunk->heads().end(); ++it ) {
+
+            double  q_spap = q[it->second];
+#else
+        for ( std::map<SPOTriplet, QlPerceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
 
             double  q_spap = ( * ( it->second ) ) ( image );
+#endif
             double explor = f ( q_spap, frqs[it->first][prg] );
 
 #ifdef QNN_DEBUG_BREL
@@ -555,7 +1505,11 @@ public:
             }
         }
 #ifdef QNN_DEBUG
+#ifdef SHARED_TRUNK
+        relevance = ( rel - sum/ ( ( double ) q.size() ) ) / ( b-a );
+#else
         relevance = ( rel - sum/ ( ( double ) prcps.size() ) ) / ( b-a );
+#endif
 #endif
 
         return ap;
@@ -571,7 +1525,7 @@ public:
         double a = std::numeric_limits<double>::max(), b = -std::numeric_limits<double>::max();
 #endif
 
-        for ( std::map<Feeling, Perceptron*>::iterator it=prcps_f.begin(); it!=prcps_f.end(); ++it ) {
+        for ( std::map<Feeling, Perceptron<>*>::iterator it=prcps_f.begin(); it!=prcps_f.end(); ++it ) {
 
             double  q_spap = ( * ( it->second ) ) ( image );
             double explor = f ( q_spap, frqs_f[it->first][prg] );
@@ -604,6 +1558,7 @@ public:
     }
 #endif
 
+    // the image is not copied, it must stay unchanged until the next call, see FrameStore
     SPOTriplet operator() ( SPOTriplet triplet, std::string prg, double image[] ) {
 
         *this << triplet;
@@ -621,32 +1576,20 @@ public:
         Feeling feeling = prcps_f.begin()->first;
 #endif
 
-        if ( prcps.find ( triplet ) == prcps.end() ) {
-
-#ifdef PLACE_VALUE
-//        prcps[triplet] = new Perceptron ( 3, 10*3, 4,  1 ); //exp.a1 // 302
-            prcps[triplet] = new Perceptron ( 5, 10*3, 16, 8, 4,  1 );
-
-#elif FOUR_TIMES
-            prcps[triplet] = new Perceptron ( 3, 2*10*2*80, 32,  1 );
-
-#elif CHARACTER_CONSOLE
-            prcps[triplet] = new Perceptron ( 3, 10*80, 32,  1 ); //exp.a1 // 302
+#ifdef SHARED_TRUNK
+        if ( !trunk ) {
+            trunk = new_trunk();
+        }
 
-            //prcps[triplet] = new Perceptron ( 3, 10*80, 64,  1 ); //exp.a4
-            //prcps[triplet] = new Perceptron ( 4, 10*80, 256, 32,  1 );
-            //prcps[triplet] = new Perceptron ( 5, 10*80, 256, 128, 32, 1 ); // 355
-            //prcps[triplet] = new Perceptron ( 5, 10*80, 196, 32,  32, 1 ); // 302
-            //prcps[triplet] = new Perceptron ( 5, 10*80, 400, 400,  32, 1 ); // 302
-#elif LIFEOFGAME
-            //prcps[triplet] = new Perceptron ( 3, 9, 32, 1 );
-//	    prcps[triplet] = new Perceptron ( 4, 2, 64, 9, 1 );
-            prcps[triplet] = new Perceptron ( 3, 2, 6, 1 );
+        if ( !trunk->has ( triplet ) ) {
+            trunk->add ( triplet );
+        }
 #else
-            prcps[triplet] = new Perceptron ( 3, 256*256, 80, 1 );
-            //prcps[triplet] = new Perceptron ( 3, 256*256, 400, 1 );
-#endif
+        if ( prcps.find ( triplet ) == prcps.end() ) {
+
+            prcps[triplet] = new QlPerceptron;
         }
+#endif
 
         SPOTriplet action = triplet;
 
@@ -658,6 +1601,8 @@ public:
 
 #ifndef SARSA
             double max_ap_q_sp_ap = max_ap_Q_sp_ap ( image );
+#elif defined(SHARED_TRUNK)
+            double max_ap_q_sp_ap = ( *trunk ) ( image, action );
 #else
             double max_ap_q_sp_ap = ( *prcps[action] ) ( image );
 #endif
@@ -668,7 +1613,11 @@ public:
             double old_q_q_s_a_nn_q_s_a;
 
             for ( int z {0}; z<10; ++z ) {
+#ifdef SHARED_TRUNK
+                double nn_q_s_a = ( *trunk ) ( prev_image, prev_action );
+#else
                 double nn_q_s_a = ( *prcps[prev_action] ) ( prev_image );
+#endif
 #ifdef FEELINGS
                 double nn_q_s_a_f = ( *prcps_f[prev_feeling] ) ( prev_image );
 #endif
@@ -682,7 +1631,11 @@ public:
                                    alpha ( frqs_f[prev_feeling][prev_state] ) *
                                    ( reward + gamma * max_ap_q_sp_ap_f - nn_q_s_a_f );
 #endif
+#ifdef SHARED_TRUNK
+                trunk->learning ( prev_image, prev_action, q_q_s_a );
+#else
                 prcps[prev_action]->learning ( prev_image, q_q_s_a, nn_q_s_a );
+#endif
 
 #ifdef FEELINGS
                 prcps_f[prev_feeling]->learning ( prev_image, q_q_s_a_f, nn_q_s_a_f );
@@ -735,20 +1688,8 @@ public:
         prev_feeling = feeling;	// a <- a'
 #endif
 
-#ifdef PLACE_VALUE
-        std::memcpy ( prev_image, image, 10*3*sizeof ( double ) );
-#elif FOUR_TIMES
-        std::memcpy ( prev_image, image, 2*10*2*80*sizeof ( double ) );
-#elif CHARACTER_CONSOLE
-        std::memcpy ( prev_image, image, 10*80*sizeof ( double ) );
-#elif LIFEOFGAME
-        std::memcpy ( prev_image, image, 40*sizeof ( double ) );
-
+        prev_image = image;
 
-
-#else
-        std::memcpy ( prev_image, image, 256*256*sizeof ( double ) );
-#endif
         return action;
     }
 
@@ -818,20 +1759,26 @@ public:
                     reinforced_action.first = prev_state;
                     reinforced_action.second = prev_action;
 
-                    ++rules[reinforced_action];
+                    int n = ++rules[reinforced_action];
 
+                    if ( SamuJournal::on() ) {
+                        SamuJournal::rule ( journal_mpu, journal_cell, reinforced_action, n );
+                    }
                 }
 
-                ++frqs[prev_action][prev_state];
+                int & frq = ++frqs[prev_action][prev_state];
 
                 table_[triplet][prg] = table_[triplet][prg];
 
                 double max_ap_q_sp_ap = max_ap_Q_sp_ap ( prg );
 
-                table_[prev_action][prev_state] =
-                    table_[prev_action][prev_state] +
-                    alpha ( frqs[prev_action][prev_state] ) *
-                    ( reward + gamma * max_ap_q_sp_ap - table_[prev_action][prev_state] );
+                double & q = table_[prev_action][prev_state];
+
+                q = q + alpha ( frq ) * ( reward + gamma * max_ap_q_sp_ap - q );
+
+                if ( SamuJournal::on() ) {
+                    SamuJournal::table ( journal_mpu, journal_cell, prev_action, prev_state, q, frq );
+                }
             }
 
             action = argmax_ap_f ( prg );
@@ -909,7 +1856,7 @@ public:
             samuFile << prcps.size();
 
             int prev_p {0};
-            for ( std::map<SPOTriplet, Perceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
+            for ( std::map<SPOTriplet, QlPerceptron*>::iterator it=prcps.begin(); it!=prcps.end(); ++it ) {
                 int p = ( std::distance ( prcps.begin(), it ) * 100 ) / prcps.size();
                 if ( p > prev_p+9 ) {
                     std::cerr << "Saving Samu: "
@@ -982,7 +1929,7 @@ public:
 
                 file >> t;
 
-                prcps[t] = new Perceptron ( file );
+                prcps[t] = new Perceptron<> ( file );
             }
 
         }
@@ -1059,6 +2006,12 @@ public:
         }
     }
 
+    // the MPU and the cell of the QL in the deltas of SamuJournal
+    void tag ( int mpu, int cell ) {
+        journal_mpu = mpu;
+        journal_cell = cell;
+    }
+
     ReinforcedAction reinforcedAction() const {
         return reinforced_action;
     }
@@ -1067,9 +2020,151 @@ public:
         return rules.size();
     }
 
+    /**
+     * The snapshot of the QL (SamuSnapshot.h): the tree and its current
+     * node, the Q table or the perceptrons, the frequencies, the rules and
+     * the previous state, action and reward. The image of the previous call
+     * belongs to the FrameStore of the MPU, so it is saved by the MPU.
+     */
+    void save ( SamuWriter & out ) const {
+        save_tree ( &root, out );
+
+        std::vector<SPOTriplet> path;
+        tree_path ( &root, path );
+        out.put ( path );
+
+#ifdef Q_LOOKUP_TABLE
+        out.put ( table_ );
+#elif defined(SHARED_TRUNK)
+        out.put<std::uint8_t> ( trunk != nullptr );
+        if ( trunk ) {
+            trunk->save ( out );
+        }
+#else
+        out.put<std::uint64_t> ( prcps.size() );
+        for ( const std::pair<const SPOTriplet, QlPerceptron*> & p : prcps ) {
+            out.put ( p.first );
+            p.second->save ( out );
+        }
+#endif
+
+        out.put ( frqs );
+        out.put ( rules );
+        out.put ( reinforced_action );
+        out.put ( prev_action );
+        out.put ( prev_state );
+        out.put ( prev_reward );
+        out.put ( N_e );
+    }
+
+    // into a new QL
+    bool restore ( SamuReader & in ) {
+        if ( !restore_tree ( &root, in, 0 ) ) {
+            return false;
+        }
+
+        std::vector<SPOTriplet> path;
+        in.get ( path );
+        for ( SPOTriplet & triplet : path ) {
+            tree = tree->getChild ( triplet );
+            if ( !tree ) {
+                return false;
+            }
+        }
+        depth = path.size();
+
+#ifdef Q_LOOKUP_TABLE
+        in.get ( table_ );
+#elif defined(SHARED_TRUNK)
+        std::uint8_t has_trunk;
+        in.get ( has_trunk );
+        if ( has_trunk ) {
+            trunk = new_trunk();
+            if ( !trunk->restore ( in ) ) {
+                return false;
+            }
+        }
+#else
+        std::uint64_t n;
+        in.get ( n );
+        for ( std::uint64_t i {0}; i < n && in.ok(); ++i ) {
+            SPOTriplet triplet;
+            in.get ( triplet );
+
+            QlPerceptron * p = new QlPerceptron;
+            prcps.emplace_hint ( prcps.end(), triplet, p );
+            p->restore ( in );
+        }
+#endif
+
+        in.get ( frqs );
+        in.get ( rules );
+        in.get ( reinforced_action );
+        in.get ( prev_action );
+        in.get ( prev_state );
+        in.get ( prev_reward );
+        in.get ( N_e );
+
+        return in.ok();
+    }
+
+#ifndef Q_LOOKUP_TABLE
+    // the image of the previous call, see FrameStore
+    const double * previousImage() const {
+        return prev_image;
+    }
+    void setPreviousImage ( double * image ) {
+        prev_image = image;
+    }
+#endif
+
+    SamuMemory memory() const {
+        SamuMemory m;
+
+#ifdef Q_LOOKUP_TABLE
+        m.add ( SamuMemory::TABLE, table_ );
+#elif defined(SHARED_TRUNK)
+        if ( trunk ) {
+            m.bytes[SamuMemory::PERCEPTRONS] += trunk->bytes();
+            m.entries[SamuMemory::PERCEPTRONS] += trunk->n_weights();
+        }
+#else
+        m.bytes[SamuMemory::PERCEPTRONS] += prcps.size() *SamuMemory::node ( prcps );
+        for ( const std::pair<const SPOTriplet, QlPerceptron*> & p : prcps ) {
+            m.bytes[SamuMemory::PERCEPTRONS] += p.second->bytes();
+            m.entries[SamuMemory::PERCEPTRONS] += p.second->n_weights();
+        }
+#endif
+#if !defined(Q_LOOKUP_TABLE) && defined(FEELINGS)
+        m.bytes[SamuMemory::PERCEPTRONS] += SamuMemory::heap ( prcps_f );
+        for ( const std::pair<const Feeling, Perceptron<>*> & p : prcps_f ) {
+            m.bytes[SamuMemory::PERCEPTRONS] += p.second->bytes();
+            m.entries[SamuMemory::PERCEPTRONS] += p.second->n_weights();
+        }
+#endif
+
+        m.add ( SamuMemory::FRQS, frqs );
+#ifdef FEELINGS
+        m.add ( SamuMemory::FRQS, frqs_f );
+#endif
+        m.add ( SamuMemory::RULES, rules );
+        tree_memory ( &root, m );
+
+        m.other += sizeof ( *this );
+
+        return m;
+    }
+
 
 private:
 
+    // the micro-benchmarks of the kernels (bench/KernelBench.cpp)
+    friend class SamuBench;
+    // the deltas are applied to the tables directly
+    friend class SamuJournal;
+    // the compact form of the tables for searching
+    friend class FrozenQL;
+
     class TripletNode
     {
     public:
@@ -1094,6 +2189,9 @@ private:
         std::map<SPOTriplet, TripletNode*> & getChildren () {
             return children;
         }
+        const std::map<SPOTriplet, TripletNode*> & getChildren () const {
+            return children;
+        }
         SPOTriplet getTriplet () const {
             return triplet;
         }
@@ -1109,6 +2207,19 @@ private:
     TripletNode *tree;
     int depth {0};
 
+    // the root is a member, the other nodes are on the heap
+    void tree_memory ( const TripletNode * node, SamuMemory & m ) const {
+        const std::map<SPOTriplet, TripletNode*> & children = node->getChildren();
+
+        m.bytes[SamuMemory::TREE] += SamuMemory::heap ( children );
+
+        for ( const std::pair<const SPOTriplet, TripletNode*> & child : children ) {
+            m.bytes[SamuMemory::TREE] += sizeof ( TripletNode );
+            ++m.entries[SamuMemory::TREE];
+            tree_memory ( child.second, m );
+        }
+    }
+
     /*
     std::random_device zinit;
     std::default_random_engine zgen {zinit() };
@@ -1137,6 +2248,81 @@ private:
         }
     }
 
+    // the path from the root to the current node of the tree
+    bool tree_path ( const TripletNode * node, std::vector<SPOTriplet> & path ) const {
+        if ( node == tree ) {
+            return true;
+        }
+
+        for ( const std::pair<const SPOTriplet, TripletNode*> & child : node->getChildren() ) {
+            path.push_back ( child.first );
+            if ( tree_path ( child.second, path ) ) {
+                return true;
+            }
+            path.pop_back();
+        }
+
+        return false;
+    }
+
+    // the children of a node in preorder
+    void save_tree ( const TripletNode * node, SamuWriter & out ) const {
+        const std::map<SPOTriplet, TripletNode*> & children = node->getChildren();
+
+        out.put<std::uint32_t> ( children.size() );
+
+        for ( const std::pair<const SPOTriplet, TripletNode*> & child : children ) {
+            out.put ( child.first );
+            save_tree ( child.second, out );
+        }
+    }
+
+    bool restore_tree ( TripletNode * node, SamuReader & in, int level ) {
+        std::uint32_t n;
+
+        if ( !in.get ( n ) || level > max_tree_depth ) {
+            return false;
+        }
+
+        std::map<SPOTriplet, TripletNode*> & children = node->getChildren();
+
+        for ( std::uint32_t i {0}; i < n; ++i ) {
+            SPOTriplet triplet;
+
+            if ( !in.get ( triplet ) ) {
+                return false;
+            }
+
+            TripletNode * child = new TripletNode ( triplet );
+            children.emplace_hint ( children.end(), triplet, child );
+
+            if ( !restore_tree ( child, in, level+1 ) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // operator<< does not go deeper than 10, a deeper tree is a corrupt snapshot
+    static const int max_tree_depth {16};
+
+#ifdef SHARED_TRUNK
+    static MultiHeadPerceptron * new_trunk() {
+#ifdef PLACE_VALUE
+        return new MultiHeadPerceptron ( 4, 10*3, 16, 8, 4 );
+#elif FOUR_TIMES
+        return new MultiHeadPerceptron ( 2, 2*10*2*80, 32 );
+#elif CHARACTER_CONSOLE
+        return new MultiHeadPerceptron ( 2, 10*80, 32 );
+#elif LIFEOFGAME
+        return new MultiHeadPerceptron ( 2, 2, 6 );
+#else
+        return new MultiHeadPerceptron ( 2, 256*256, 80 );
+#endif
+    }
+#endif
+
     int N_e = 50;
 
     QL ( const QL & );
@@ -1150,10 +2336,14 @@ private:
 
 #ifdef Q_LOOKUP_TABLE
     std::map<SPOTriplet, std::map<std::string, double>> table_;
+#elif defined(SHARED_TRUNK)
+    MultiHeadPerceptron *trunk {nullptr};
 #else
-    std::map<SPOTriplet, Perceptron*> prcps;
+    std::map<SPOTriplet, QlPerceptron*> prcps;
+#endif
+#ifndef Q_LOOKUP_TABLE
 #ifdef FEELINGS
-    std::map<Feeling, Perceptron*> prcps_f;
+    std::map<Feeling, Perceptron<>*> prcps_f;
 #endif
 #ifdef QNN_DEBUG
     double relevance {0.0};
@@ -1183,20 +2373,166 @@ private:
     double max_reward {10.20};
     double min_reward {-10.70};
 
-#ifdef PLACE_VALUE
-    double prev_image [10*3];
-#elif FOUR_TIMES
-    double prev_image [2*10*2*80];
-#elif CHARACTER_CONSOLE
-    double prev_image [10*80];
-#elif LIFEOFGAME
-    double prev_image [40];
-#else
-    double prev_image [256*256];
+#ifndef Q_LOOKUP_TABLE
+    // a handle to the image of the previous call, see FrameStore
+    double *prev_image {nullptr};
 #endif
 
     ReinforcedAction reinforced_action {"unreinforced", -1};
     std::map<ReinforcedAction, int> rules;
+
+    int journal_mpu {-1};
+    int journal_cell {-1};
+};
+
+#ifdef Q_LOOKUP_TABLE
+/**
+ * The read-only form of the Q table of a QL for searching an MPU that has
+ * been paged out (see MentalProcessingUnit::pageOut). The states are sorted
+ * in one block of characters and the Q values and the frequencies of a
+ * state are in a row with a column for each action, so a call of a QL that
+ * does not learn is a binary search and a scan of a row. It computes the
+ * same actions as QL does and it keeps the previous state, action and
+ * reward, they are put back into the QL when the MPU is paged in.
+ */
+class FrozenQL
+{
+public:
+    explicit FrozenQL ( const QL & ql ) :
+        N_e ( ql.N_e ), max_reward ( ql.max_reward ), min_reward ( ql.min_reward ),
+        num_rules ( ql.rules.size() ), prev_action ( ql.prev_action ),
+        prev_state ( ql.prev_state ), prev_reward ( ql.prev_reward ) {
+
+        std::map<std::string, std::size_t> states;
+
+        for ( const std::pair<const SPOTriplet, std::map<std::string, double>> & a : ql.table_ ) {
+            actions.push_back ( a.first );
+
+            for ( const std::pair<const std::string, double> & e : a.second ) {
+                states.emplace ( e.first, 0 );
+            }
+
+            std::map<SPOTriplet, std::map<std::string, int>>::const_iterator f = ql.frqs.find ( a.first );
+            if ( f != ql.frqs.end() )
+                for ( const std::pair<const std::string, int> & e : f->second ) {
+                    states.emplace ( e.first, 0 );
+                }
+        }
+
+        for ( std::pair<const std::string, std::size_t> & state : states ) {
+            state.second = offsets.size();
+            offsets.push_back ( chars.size() );
+            chars.insert ( chars.end(), state.first.begin(), state.first.end() );
+        }
+        offsets.push_back ( chars.size() );
+
+        qs.assign ( states.size() *actions.size(), 0.0 );
+        ns.assign ( states.size() *actions.size(), 0 );
+
+        for ( std::size_t i {0}; i < actions.size(); ++i ) {
+            for ( const std::pair<const std::string, double> & e : ql.table_.at ( actions[i] ) ) {
+                qs[states[e.first]*actions.size() + i] = e.second;
+            }
+
+            std::map<SPOTriplet, std::map<std::string, int>>::const_iterator f = ql.frqs.find ( actions[i] );
+            if ( f != ql.frqs.end() )
+                for ( const std::pair<const std::string, int> & e : f->second ) {
+                    ns[states[e.first]*actions.size() + i] = e.second;
+                }
+        }
+    }
+
+    // QL::operator() without learning
+    SPOTriplet operator() ( SPOTriplet triplet, const std::string & prg ) {
+        double reward = ( triplet == prev_action ) ?max_reward:min_reward;
+
+        SPOTriplet action = triplet;
+
+        if ( prev_reward >  -std::numeric_limits<double>::max() ) {
+            action = argmax_ap_f ( prg );
+        }
+
+        prev_state = prg;
+        prev_reward = reward;
+        prev_action = action;
+
+        return action;
+    }
+
+    int getNumRules() const {
+        return num_rules;
+    }
+
+    // the state of the last call into the QL of the same table
+    void thaw ( QL & ql ) const {
+        ql.prev_action = prev_action;
+        ql.prev_state = prev_state;
+        ql.prev_reward = prev_reward;
+    }
+
+    std::size_t bytes() const {
+        return sizeof ( *this ) + actions.capacity() *sizeof ( SPOTriplet ) + chars.capacity()
+               + offsets.capacity() *sizeof ( std::uint32_t ) + qs.capacity() *sizeof ( double )
+               + ns.capacity() *sizeof ( int ) + SamuMemory::heap ( prev_state );
+    }
+
+private:
+    // the row of a state, -1 if it has not been seen
+    long row ( const std::string & prg ) const {
+        long lo {0}, hi = offsets.size() - 1;
+
+        while ( lo < hi ) {
+            long mid = ( lo+hi ) / 2;
+            int c = prg.compare ( 0, std::string::npos, chars.data() + offsets[mid], offsets[mid+1] - offsets[mid] );
+
+            if ( c == 0 ) {
+                return mid;
+            } else if ( c < 0 ) {
+                hi = mid;
+            } else {
+                lo = mid+1;
+            }
+        }
+
+        return -1;
+    }
+
+    SPOTriplet argmax_ap_f ( const std::string & prg ) const {
+        double min_f = -std::numeric_limits<double>::max();
+        SPOTriplet ap {0};
+
+        long r = row ( prg );
+
+        for ( std::size_t i {0}; i < actions.size(); ++i ) {
+            double q_spap = r < 0 ? 0.0 : qs[r*actions.size() + i];
+            int n = r < 0 ? 0 : ns[r*actions.size() + i];
+
+            double explor = n < N_e ? max_reward : q_spap;
+
+            if ( explor > min_f ) {
+                min_f = explor;
+                ap = actions[i];
+            }
+        }
+
+        return ap;
+    }
+
+    std::vector<SPOTriplet> actions;
+    std::vector<char> chars;
+    std::vector<std::uint32_t> offsets;
+    std::vector<double> qs;
+    std::vector<int> ns;
+
+    int N_e;
+    double max_reward;
+    double min_reward;
+    int num_rules;
+
+    SPOTriplet prev_action;
+    std::string prev_state;
+    double prev_reward;
 };
+#endif
 
 #endif
@@ -0,0 +1,80 @@
+#ifndef SamuRing_H
+#define SamuRing_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuRing.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * A single producer, single consumer ring of fixed size items. It is the
+ * hand-off between a thread of the simulation and a background thread
+ * (the monitor stream and the trace), pushing is a copy and two atomic
+ * stores, it never allocates.
+ */
+
+#include <atomic>
+#include <cstdint>
+
+template <typename T, std::uint32_t capacity>
+class SamuRing
+{
+    static_assert ( ( capacity & ( capacity-1 ) ) == 0, "the capacity is a power of two" );
+
+public:
+    bool push ( const T & item ) {
+        std::uint32_t h = head.load ( std::memory_order_relaxed );
+
+        if ( h - tail.load ( std::memory_order_acquire ) == capacity ) {
+            return false;
+        }
+
+        items[h & ( capacity-1 )] = item;
+        head.store ( h+1, std::memory_order_release );
+
+        return true;
+    }
+
+    bool pop ( T & item ) {
+        std::uint32_t t = tail.load ( std::memory_order_relaxed );
+
+        if ( t == head.load ( std::memory_order_acquire ) ) {
+            return false;
+        }
+
+        item = items[t & ( capacity-1 )];
+        tail.store ( t+1, std::memory_order_release );
+
+        return true;
+    }
+
+private:
+    // the producer and the consumer indices are on different cache lines
+    std::atomic<std::uint32_t> head {0};
+    char head_line[64 - sizeof ( std::atomic<std::uint32_t> )];
+    std::atomic<std::uint32_t> tail {0};
+    char tail_line[64 - sizeof ( std::atomic<std::uint32_t> )];
+    T items[capacity];
+};
+
+#endif
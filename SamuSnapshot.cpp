@@ -0,0 +1,209 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuSnapshot.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The read-only memory mapping of the snapshots and the store of the
+ * records.
+ */
+
+#include <cstdio>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SamuSnapshot.h"
+
+SamuMapping::SamuMapping ( const char * path )
+{
+  int fd = ::open ( path, O_RDONLY );
+
+  if ( fd < 0 )
+    {
+      return;
+    }
+
+  struct stat st;
+
+  if ( !::fstat ( fd, &st ) && st.st_size > 0 )
+    {
+      void * p = ::mmap ( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+      if ( p != MAP_FAILED )
+        {
+          // the snapshot is read once from the beginning to the end
+          ::madvise ( p, st.st_size, MADV_SEQUENTIAL );
+
+          data = static_cast<const char *> ( p );
+          size = st.st_size;
+        }
+    }
+
+  // the mapping stays valid after closing
+  ::close ( fd );
+}
+
+SamuMapping::~SamuMapping()
+{
+  if ( data )
+    {
+      ::munmap ( const_cast<char *> ( data ), size );
+    }
+}
+
+bool SamuStore::open ( const char * path )
+{
+  this->path = path;
+
+  writer.reset();
+  mapping.reset();
+  file.close();
+  file.clear();
+  file.open ( path, std::ios::binary | std::ios::trunc );
+  writer.reset ( new SamuWriter ( file ) );
+
+  mapped = end_offset = live_bytes = 0;
+  records.clear();
+  unused.clear();
+  good = static_cast<bool> ( file );
+
+  return good;
+}
+
+SamuWriter & SamuStore::begin()
+{
+  begin_offset = end_offset;
+
+  return *writer;
+}
+
+int SamuStore::end()
+{
+  file.flush();
+
+  Record record {begin_offset, static_cast<std::uint64_t> ( file.tellp() ) - begin_offset};
+
+  good = good && file;
+  end_offset = record.offset + record.size;
+  live_bytes += record.size;
+
+  if ( unused.empty() )
+    {
+      records.push_back ( record );
+      return records.size() - 1;
+    }
+
+  int handle = unused.back();
+  unused.pop_back();
+  records[handle] = record;
+
+  return handle;
+}
+
+SamuReader SamuStore::read ( int handle )
+{
+  if ( end_offset > mapped )
+    {
+      map();
+    }
+
+  const Record & record = records[handle];
+
+  if ( !mapping || !mapping->ok() || record.offset + record.size > mapped )
+    {
+      return SamuReader ( nullptr, nullptr );
+    }
+
+  return SamuReader ( mapping->begin() + record.offset, mapping->begin() + record.offset + record.size );
+}
+
+void SamuStore::free ( int handle )
+{
+  live_bytes -= records[handle].size;
+  records[handle].offset = std::numeric_limits<std::uint64_t>::max();
+  records[handle].size = 0;
+  unused.push_back ( handle );
+
+  std::uint64_t garbage = end_offset - live_bytes;
+
+  if ( garbage > live_bytes && garbage >= ( 1u << 20 ) )
+    {
+      compact();
+    }
+}
+
+void SamuStore::map()
+{
+  mapping.reset ( new SamuMapping ( path.c_str() ) );
+  mapped = mapping->ok() ? end_offset : 0;
+}
+
+// the live records are copied into a new file
+void SamuStore::compact()
+{
+  if ( end_offset > mapped )
+    {
+      map();
+    }
+
+  if ( !mapping || !mapping->ok() )
+    {
+      return;
+    }
+
+  std::string tmp = path + ".tmp";
+  std::ofstream out ( tmp.c_str(), std::ios::binary | std::ios::trunc );
+  std::vector<Record> moved ( records );
+  std::uint64_t offset {0};
+
+  for ( Record & record : moved )
+    if ( record.size )
+      {
+        out.write ( mapping->begin() + record.offset, record.size );
+        record.offset = offset;
+        offset += record.size;
+      }
+
+  out.close();
+
+  if ( !out || std::rename ( tmp.c_str(), path.c_str() ) )
+    {
+      std::remove ( tmp.c_str() );
+      return;
+    }
+
+  records.swap ( moved );
+  mapping.reset();
+  mapped = 0;
+  end_offset = offset;
+
+  writer.reset();
+  file.close();
+  file.clear();
+  file.open ( path.c_str(), std::ios::binary | std::ios::in | std::ios::out );
+  file.seekp ( 0, std::ios::end );
+  writer.reset ( new SamuWriter ( file ) );
+  good = static_cast<bool> ( file );
+}
@@ -0,0 +1,281 @@
+#ifndef SamuSnapshot_H
+#define SamuSnapshot_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuSnapshot.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The binary snapshot of a SamuBrain (SamuBrain::save, SamuBrain::restore).
+ * The classes write their own state with a SamuWriter and read it back
+ * with a SamuReader, in the same order. The values are written as they
+ * are in the memory (the snapshot is for the same machine and the same
+ * build), the strings and the containers are prefixed with their sizes
+ * and the maps are written in their order, so they are rebuilt from the
+ * end without searching.
+ *
+ * The file is a header (magic, version, the layout of the build, the
+ * size of the lattice) and the brain. A snapshot is restored from a
+ * read-only memory mapping of the file (SamuMapping).
+ *
+ * The MPUs paged out of the memory are records of a SamuStore.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class SamuWriter
+{
+public:
+    explicit SamuWriter ( std::ostream & out ) : out ( out )
+    {}
+
+    template <typename T>
+    void put ( const T & value ) {
+        static_assert ( std::is_trivially_copyable<T>::value, "a value is written as it is" );
+        out.write ( reinterpret_cast<const char *> ( &value ), sizeof ( T ) );
+    }
+
+    void put ( const std::string & s ) {
+        put<std::uint32_t> ( s.size() );
+        out.write ( s.data(), s.size() );
+    }
+
+    template <typename T>
+    void put ( const T * values, std::size_t n ) {
+        static_assert ( std::is_trivially_copyable<T>::value, "a value is written as it is" );
+        out.write ( reinterpret_cast<const char *> ( values ), n*sizeof ( T ) );
+    }
+
+    template <typename T>
+    void put ( const std::vector<T> & values ) {
+        put<std::uint64_t> ( values.size() );
+        put ( values.data(), values.size() );
+    }
+
+    template <typename K, typename V>
+    void put ( const std::map<K, V> & map ) {
+        put<std::uint64_t> ( map.size() );
+        for ( const std::pair<const K, V> & kv : map ) {
+            put ( kv.first );
+            put ( kv.second );
+        }
+    }
+
+    template <typename A, typename B>
+    void put ( const std::pair<A, B> & pair ) {
+        put ( pair.first );
+        put ( pair.second );
+    }
+
+    bool ok() const {
+        return static_cast<bool> ( out );
+    }
+
+private:
+    std::ostream & out;
+};
+
+class SamuReader
+{
+public:
+    SamuReader ( const char * begin, const char * end ) : p ( begin ), end ( end )
+    {}
+
+    // a truncated or corrupt snapshot makes it bad, then it reads zeros
+    template <typename T>
+    bool get ( T & value ) {
+        static_assert ( std::is_trivially_copyable<T>::value, "a value is read as it is" );
+        if ( !take ( sizeof ( T ) ) ) {
+            value = T();
+            return false;
+        }
+        std::memcpy ( &value, p - sizeof ( T ), sizeof ( T ) );
+        return true;
+    }
+
+    bool get ( std::string & s ) {
+        std::uint32_t n;
+        if ( !get ( n ) || !take ( n ) ) {
+            s.clear();
+            return false;
+        }
+        s.assign ( p - n, n );
+        return true;
+    }
+
+    template <typename T>
+    bool get ( T * values, std::size_t n ) {
+        static_assert ( std::is_trivially_copyable<T>::value, "a value is read as it is" );
+        if ( !take ( n*sizeof ( T ) ) ) {
+            return false;
+        }
+        // the data of an empty vector can be null
+        if ( n ) {
+            std::memcpy ( values, p - n*sizeof ( T ), n*sizeof ( T ) );
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool get ( std::vector<T> & values ) {
+        std::uint64_t n;
+        values.clear();
+        if ( !get ( n ) || n > static_cast<std::size_t> ( end - p ) /sizeof ( T ) ) {
+            good = false;
+            return false;
+        }
+        values.resize ( n );
+        return get ( values.data(), n );
+    }
+
+    template <typename K, typename V>
+    bool get ( std::map<K, V> & map ) {
+        std::uint64_t n;
+        map.clear();
+        if ( !get ( n ) ) {
+            return false;
+        }
+        for ( std::uint64_t i {0}; i<n && good; ++i ) {
+            K key;
+            get ( key );
+            V & value = map.emplace_hint ( map.end(), std::move ( key ), V() )->second;
+            get ( value );
+        }
+        return good;
+    }
+
+    template <typename A, typename B>
+    bool get ( std::pair<A, B> & pair ) {
+        get ( pair.first );
+        return get ( pair.second );
+    }
+
+    bool ok() const {
+        return good;
+    }
+
+private:
+    bool take ( std::size_t n ) {
+        if ( !good || static_cast<std::size_t> ( end - p ) < n ) {
+            good = false;
+            return false;
+        }
+        p += n;
+        return true;
+    }
+
+    const char * p;
+    const char * end;
+    bool good {true};
+};
+
+// a read-only memory mapping of a file
+class SamuMapping
+{
+public:
+    explicit SamuMapping ( const char * path );
+    ~SamuMapping();
+
+    const char * begin() const {
+        return data;
+    }
+    const char * end() const {
+        return data + size;
+    }
+    bool ok() const {
+        return data != nullptr;
+    }
+
+private:
+    SamuMapping ( const SamuMapping & );
+    SamuMapping & operator= ( const SamuMapping & );
+
+    const char * data {nullptr};
+    std::size_t size {0};
+};
+
+/**
+ * A file of records written with a SamuWriter and read with a SamuReader
+ * through a mapping of the file. A record is referred by its handle, the
+ * space of the freed records is reclaimed by rewriting the file when the
+ * most of it is garbage (the handles remain valid).
+ */
+class SamuStore
+{
+public:
+    // a new empty store
+    bool open ( const char * path );
+
+    // a new record: it is written with the writer of begin(), end() closes it
+    SamuWriter & begin();
+    int end();
+
+    // a reader of a record, until the next begin()
+    SamuReader read ( int handle );
+    void free ( int handle );
+
+    bool ok() const {
+        return good;
+    }
+    // the size of the file and of its live records
+    std::uint64_t bytes() const {
+        return end_offset;
+    }
+    std::uint64_t live() const {
+        return live_bytes;
+    }
+
+private:
+    struct Record {
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    void map();
+    void compact();
+
+    std::string path;
+    std::ofstream file;
+    std::unique_ptr<SamuWriter> writer;
+    std::unique_ptr<SamuMapping> mapping;
+    std::uint64_t mapped {0};
+
+    std::vector<Record> records;
+    std::vector<int> unused;
+    std::uint64_t end_offset {0};
+    std::uint64_t live_bytes {0};
+    std::uint64_t begin_offset {0};
+    bool good {false};
+};
+
+#endif
@@ -0,0 +1,386 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuSource.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The streams of frames: the reading and the decoding thread and the
+ * hand-off of the frames to the learner.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include "SamuSource.h"
+
+SamuStream::~SamuStream()
+{
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+    stopping = true;
+  }
+  changed.notify_all();
+
+  if ( thread.joinable() )
+    {
+      thread.join();
+    }
+
+  // the standard input is not closed
+  if ( fd > 0 )
+    {
+      ::close ( fd );
+    }
+}
+
+bool SamuStream::open ( const char * path, SamuFormat format, int w, int h )
+{
+  fd = std::strcmp ( path, "-" ) ? ::open ( path, O_RDONLY ) : 0;
+
+  if ( fd < 0 )
+    {
+      return false;
+    }
+
+  m_format = format;
+  input.resize ( 1 << 16 );
+
+  if ( format == SamuFormat::PBM )
+    {
+      // it waits for the writer of a pipe
+      if ( !header ( pendingType, w, h ) )
+        {
+          return false;
+        }
+      pending = true;
+    }
+  else if ( w <= 0 || h <= 0 )
+    {
+      return false;
+    }
+
+  m_w = w;
+  m_h = h;
+  row.resize ( format == SamuFormat::PBM ? ( w+7 ) /8 : w );
+
+  for ( Frame & frame : frames )
+    {
+      frame.cells.assign ( static_cast<std::size_t> ( w ) *h, 0 );
+      frame.rows.resize ( h );
+      for ( int r {0}; r<h; ++r )
+        {
+          frame.rows[r] = frame.cells.data() + static_cast<std::size_t> ( r ) *w;
+        }
+    }
+
+  thread = std::thread ( &SamuStream::run, this );
+
+  return true;
+}
+
+bool SamuStream::next()
+{
+  std::unique_lock<std::mutex> lock ( mutex );
+
+  if ( learning )
+    {
+      // the learner has finished with it, the thread can decode into it
+      frames[current].state = State::FREE;
+      learning = false;
+      current ^= 1;
+      changed.notify_all();
+    }
+
+  if ( frames[current].state != State::FULL && !done )
+    {
+      ++nofUnderruns;
+      changed.wait ( lock, [this] {
+        return frames[current].state == State::FULL || done;
+      } );
+    }
+
+  if ( frames[current].state != State::FULL )
+    {
+      return false;
+    }
+
+  frames[current].state = State::LEARNING;
+  learning = true;
+  ++m_tick;
+
+  return true;
+}
+
+void SamuStream::run()
+{
+  for ( int k {0}; ; k ^= 1 )
+    {
+      Frame & frame = frames[k];
+
+      {
+        std::unique_lock<std::mutex> lock ( mutex );
+
+        if ( frame.state != State::FREE && !stopping )
+          {
+            ++nofStalls;
+            changed.wait ( lock, [this, &frame] {
+              return frame.state == State::FREE || stopping;
+            } );
+          }
+
+        if ( stopping )
+          {
+            return;
+          }
+      }
+
+      bool decoded = decode ( frame );
+
+      {
+        std::lock_guard<std::mutex> lock ( mutex );
+
+        if ( decoded )
+          {
+            frame.state = State::FULL;
+          }
+        else
+          {
+            done = true;
+            good = !bad;
+          }
+      }
+      changed.notify_all();
+
+      if ( !decoded )
+        {
+          return;
+        }
+    }
+}
+
+bool SamuStream::read ( char & c )
+{
+  while ( begin == end )
+    {
+      if ( stopping )
+        {
+          return false;
+        }
+
+      // a pipe without a writer is waited for, but not after the destructor
+      struct pollfd p = {fd, POLLIN, 0};
+
+      if ( ::poll ( &p, 1, 100 ) == 0 )
+        {
+          continue;
+        }
+
+      ssize_t n = ::read ( fd, input.data(), input.size() );
+
+      if ( n < 0 && errno == EINTR )
+        {
+          continue;
+        }
+      if ( n <= 0 )
+        {
+          return false;
+        }
+
+      begin = 0;
+      end = n;
+    }
+
+  c = input[begin++];
+
+  return true;
+}
+
+std::size_t SamuStream::read ( unsigned char * data, std::size_t n )
+{
+  std::size_t done {0};
+
+  while ( done < n )
+    {
+      char c;
+
+      if ( !read ( c ) )
+        {
+          break;
+        }
+
+      data[done++] = static_cast<unsigned char> ( c );
+
+      std::size_t m = std::min ( n - done, end - begin );
+      std::memcpy ( data + done, input.data() + begin, m );
+      begin += m;
+      done += m;
+    }
+
+  return done;
+}
+
+bool SamuStream::token ( char & c )
+{
+  for ( ;; )
+    {
+      if ( !read ( c ) )
+        {
+          return false;
+        }
+
+      if ( c == '#' )
+        {
+          while ( c != '\n' && read ( c ) )
+            ;
+        }
+      else if ( !std::isspace ( static_cast<unsigned char> ( c ) ) )
+        {
+          return true;
+        }
+    }
+}
+
+bool SamuStream::number ( int & n )
+{
+  char c;
+
+  if ( !token ( c ) || !std::isdigit ( static_cast<unsigned char> ( c ) ) )
+    {
+      return false;
+    }
+
+  for ( n = 0; std::isdigit ( static_cast<unsigned char> ( c ) ); )
+    {
+      n = 10*n + c - '0';
+
+      if ( n > ( 1 << 16 ) || !read ( c ) )
+        {
+          return false;
+        }
+    }
+
+  // a single whitespace after the height of a P4 image
+  return std::isspace ( static_cast<unsigned char> ( c ) );
+}
+
+bool SamuStream::header ( char & type, int & w, int & h )
+{
+  char c;
+
+  // the end of the stream between two images
+  if ( !token ( c ) )
+    {
+      return false;
+    }
+
+  if ( c != 'P' || !read ( type ) || ( type != '1' && type != '4' )
+       || !number ( w ) || !number ( h ) || w <= 0 || h <= 0 )
+    {
+      bad = true;
+      return false;
+    }
+
+  return true;
+}
+
+bool SamuStream::decode ( Frame & frame )
+{
+  int * cell = frame.cells.data();
+
+  if ( m_format == SamuFormat::RAW )
+    {
+      for ( int r {0}; r<m_h; ++r )
+        {
+          std::size_t n = read ( row.data(), m_w );
+
+          // the end of the stream between two frames, else a cut frame
+          if ( n < static_cast<std::size_t> ( m_w ) )
+            {
+              bad = r > 0 || n > 0;
+              return false;
+            }
+
+          for ( int c {0}; c<m_w; ++c )
+            {
+              if ( row[c] > 15 )
+                {
+                  bad = true;
+                  return false;
+                }
+              *cell++ = row[c];
+            }
+        }
+
+      return true;
+    }
+
+  char type = pendingType;
+  int w {m_w}, h {m_h};
+
+  if ( !pending && !header ( type, w, h ) )
+    {
+      return false;
+    }
+  pending = false;
+
+  if ( w != m_w || h != m_h )
+    {
+      bad = true;
+      return false;
+    }
+
+  for ( int r {0}; r<m_h; ++r )
+    {
+      if ( type == '4' )
+        {
+          if ( read ( row.data(), row.size() ) < row.size() )
+            {
+              bad = true;
+              return false;
+            }
+
+          for ( int c {0}; c<m_w; ++c )
+            {
+              *cell++ = row[c >> 3] >> ( 7 - ( c & 7 ) ) & 1;
+            }
+        }
+      else
+        for ( int c {0}; c<m_w; ++c )
+          {
+            char p;
+
+            if ( !token ( p ) || ( p != '0' && p != '1' ) )
+              {
+                bad = true;
+                return false;
+              }
+            *cell++ = p - '0';
+          }
+    }
+
+  return true;
+}
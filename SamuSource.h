@@ -0,0 +1,169 @@
+#ifndef SamuSource_H
+#define SamuSource_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuSource.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The sources of the reality that GameOfLife learns instead of its own
+ * scenarios (GameOfLife::setSource): a recording (SamuReplay) or a stream
+ * of frames (SamuStream) read from a file, a named pipe or the standard
+ * input.
+ *
+ * A stream is read by a background thread into two frames: while the
+ * learner is learning one of them, the next one is decoded into the other.
+ * The learner gets the rows of the frame itself, and the thread waits
+ * until the learner has finished with a frame before it decodes the next
+ * one into it, so a fast writer is slowed down to the learner (and a pipe
+ * blocks its writer when it is full).
+ *
+ * The formats of a stream are the concatenated PBM images (P1 or P4, a
+ * black pixel is a live cell) and the raw frames (w*h bytes, a byte is the
+ * color of a cell, 0..15).
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class SamuSource
+{
+public:
+    virtual ~SamuSource()
+    {}
+
+    virtual int getW() const = 0;
+    virtual int getH() const = 0;
+
+    // the next frame is in lattice(), false at the end of the source
+    virtual bool next() = 0;
+    // false if the source cannot start again from its first frame
+    virtual bool rewind() {
+        return false;
+    }
+
+    // the rows of the current frame, valid until the next next()
+    virtual int ** lattice() = 0;
+    // the tick of the current frame
+    virtual long tick() const = 0;
+};
+
+enum class SamuFormat {
+    PBM,
+    RAW
+};
+
+class SamuStream : public SamuSource
+{
+public:
+    ~SamuStream();
+
+    // path is a file, a named pipe or "-" (the standard input); the size of
+    // the lattice is w x h for RAW, the size of the first image for PBM
+    bool open ( const char * path, SamuFormat format, int w = 0, int h = 0 );
+
+    int getW() const override {
+        return m_w;
+    }
+    int getH() const override {
+        return m_h;
+    }
+
+    bool next() override;
+
+    int ** lattice() override {
+        return frames[current].rows.data();
+    }
+    long tick() const override {
+        return m_tick;
+    }
+
+    // false if the stream has ended with a bad frame
+    bool ok() const {
+        return good;
+    }
+    // the learner waited for a frame, the thread waited for the learner
+    std::uint64_t underruns() const {
+        return nofUnderruns;
+    }
+    std::uint64_t stalls() const {
+        return nofStalls;
+    }
+
+private:
+    enum class State {
+        FREE,
+        FULL,
+        LEARNING
+    };
+
+    struct Frame {
+        std::vector<int> cells;
+        std::vector<int *> rows;
+        State state {State::FREE};
+    };
+
+    void run();
+    bool read ( char & c );
+    // the number of the bytes read, n unless the stream has ended
+    std::size_t read ( unsigned char * data, std::size_t n );
+    // the next character that is not a whitespace or a comment
+    bool token ( char & c );
+    bool number ( int & n );
+    bool header ( char & type, int & w, int & h );
+    bool decode ( Frame & frame );
+
+    int fd {-1};
+    SamuFormat m_format {SamuFormat::PBM};
+    int m_w {0}, m_h {0};
+
+    // the buffer of the reads and a row of a frame, of the thread
+    std::vector<char> input;
+    std::size_t begin {0}, end {0};
+    std::vector<unsigned char> row;
+    bool bad {false};
+    // the header of the first image has been read by open()
+    bool pending {false};
+    char pendingType {0};
+
+    Frame frames[2];
+    int current {0};
+    bool learning {false};
+    long m_tick {0};
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool done {false};
+    std::atomic<bool> stopping {false};
+    std::atomic<bool> good {true};
+    std::atomic<std::uint64_t> nofUnderruns {0};
+    std::atomic<std::uint64_t> nofStalls {0};
+    std::thread thread;
+};
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef SamuSprite_H
+#define SamuSprite_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuSprite.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The sprites of the Stroop and Movie scenarios. A sprite is written as
+ * rows of text ('#' is a set pixel) and it is built into bit masks at
+ * compile time, so a new stimulus is a new entry of the atlas. Only the
+ * set pixels of a sprite are drawn (the lattice shows through the rest):
+ * a row is its mask clipped to the lattice, and a store per set bit.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+struct SamuSprite {
+    static const int max_h {16};
+    static const int max_w {64};
+
+    int w;
+    int h;
+    // the bit j of rows[i] is the pixel of the row i and column j
+    std::uint64_t rows[max_h];
+
+    void blit ( int ** lattice, int lw, int lh, int x, int y, int color ) const {
+        // the columns of the sprite inside the lattice
+        int j0 = x < 0 ? -x : 0;
+        int j1 = lw - x < w ? lw - x : w;
+
+        if ( j0 >= j1 ) {
+            return;
+        }
+
+        std::uint64_t clip = ( j1 - j0 == 64 ? ~std::uint64_t {0} : ( std::uint64_t {1} << ( j1 - j0 ) ) - 1 ) << j0;
+
+        for ( int i {0}; i<h; ++i ) {
+            if ( y+i < 0 || y+i >= lh ) {
+                continue;
+            }
+
+            int * row = lattice[y+i] + x;
+
+            // a store per set pixel, without branching on the pixels
+            for ( std::uint64_t bits = rows[i] & clip; bits; bits &= bits - 1 ) {
+                row[__builtin_ctzll ( bits )] = color;
+            }
+        }
+    }
+};
+
+// the rows of the text must be of the same length
+template <std::size_t H>
+constexpr SamuSprite samu_sprite ( const char * const ( &text ) [H] )
+{
+    static_assert ( H <= SamuSprite::max_h, "a sprite is at most 16 rows" );
+
+    SamuSprite sprite {0, static_cast<int> ( H ), {}};
+
+    for ( std::size_t i {0}; i<H; ++i ) {
+        int j {0};
+        for ( ; text[i][j] && j<SamuSprite::max_w; ++j ) {
+            if ( text[i][j] == '#' ) {
+                sprite.rows[i] |= std::uint64_t {1} << j;
+            }
+        }
+        if ( j > sprite.w ) {
+            sprite.w = j;
+        }
+    }
+
+    return sprite;
+}
+
+enum class SamuSpriteId : std::uint8_t {
+    RED,
+    GREEN,
+    BLUE,
+    HOUSE,
+    MAN,
+    CAR,
+    GLIDER
+};
+
+namespace samu_sprites
+{
+
+constexpr const char * red[] = {
+    "###...#####.###..",
+    "#..#..#.....#..#.",
+    "#..#..#.....#...#",
+    "###...####..#...#",
+    "#.#...#.....#...#",
+    "#..#..#.....#..#.",
+    "#...#.#####.###.."
+};
+
+constexpr const char * green[] = {
+    ".###..###...#####.#####.#...#",
+    "#...#.#..#..#.....#.....##..#",
+    "#.....#..#..#.....#.....###.#",
+    "#.###.###...####..####..#.#.#",
+    "#...#.#.#...#.....#.....#.###",
+    "#...#.#..#..#.....#.....#..##",
+    ".###..#...#.#####.#####.#...#"
+};
+
+constexpr const char * blue[] = {
+    "###..#....#...#.#####",
+    "#..#.#....#...#.#....",
+    "#..#.#....#...#.#....",
+    "###..#....#...#.####.",
+    "#..#.#....#...#.#....",
+    "#..#.#....#...#.#....",
+    "###..####..###..#####"
+};
+
+constexpr const char * house[] = {
+    "...#...",
+    "..#.#..",
+    ".#...#.",
+    "#.....#",
+    "#.....#",
+    "#.....#",
+    "#.....#",
+    "#.....#",
+    "#######"
+};
+
+constexpr const char * man[] = {
+    ".#.",
+    "###",
+    ".#.",
+    "#.#"
+};
+
+constexpr const char * car[] = {
+    ".###.",
+    "#####",
+    ".#.#."
+};
+
+constexpr const char * glider[] = {
+    "..#.",
+    ".#..",
+    ".###"
+};
+
+}
+
+// in the order of SamuSpriteId
+constexpr SamuSprite samu_atlas[] = {
+    samu_sprite ( samu_sprites::red ),
+    samu_sprite ( samu_sprites::green ),
+    samu_sprite ( samu_sprites::blue ),
+    samu_sprite ( samu_sprites::house ),
+    samu_sprite ( samu_sprites::man ),
+    samu_sprite ( samu_sprites::car ),
+    samu_sprite ( samu_sprites::glider )
+};
+
+inline const SamuSprite & samu_sprite ( SamuSpriteId id )
+{
+    return samu_atlas[static_cast<int> ( id )];
+}
+
+#endif
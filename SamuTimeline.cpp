@@ -0,0 +1,200 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuTimeline.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The parser of the scenario timelines.
+ */
+
+#include <fstream>
+#include <sstream>
+#include "SamuTimeline.h"
+
+namespace
+{
+
+// the segments of an unrolled timeline, it is a typo above this
+const std::size_t max_segments {1u << 20};
+const int max_depth {16};
+
+bool generator ( const std::string & name, SamuGenerator & g )
+{
+  static const struct
+  {
+    const char * name;
+    SamuGenerator generator;
+  } generators[] =
+  {
+    {"empty", SamuGenerator::EMPTY},
+    {"gliders", SamuGenerator::GLIDERS},
+    {"conway", SamuGenerator::CONWAY},
+    {"stroop", SamuGenerator::STROOP},
+    {"movie", SamuGenerator::MOVIE}
+  };
+
+  for ( const auto & entry : generators )
+    if ( name == entry.name )
+      {
+        g = entry.generator;
+        return true;
+      }
+
+  return false;
+}
+
+}
+
+bool SamuTimeline::load ( const char * path )
+{
+  std::ifstream in ( path );
+
+  if ( !in )
+    {
+      m_error = "cannot be read";
+      return false;
+    }
+
+  return parse ( in );
+}
+
+bool SamuTimeline::fail ( int line, const std::string & what )
+{
+  std::ostringstream ss;
+  ss << "line " << line << ": " << what;
+
+  m_error = ss.str();
+  m_segments.clear();
+  m_duration = 0;
+
+  return false;
+}
+
+bool SamuTimeline::parse ( std::istream & in )
+{
+  m_segments.clear();
+  m_duration = 0;
+  m_error.clear();
+
+  // the first segment and the count of the open repeats
+  std::vector<std::pair<std::size_t, long>> repeats;
+  std::string text;
+  int line {0};
+
+  while ( std::getline ( in, text ) )
+    {
+      ++line;
+
+      std::istringstream ss ( text.substr ( 0, text.find ( '#' ) ) );
+      std::string word;
+
+      if ( ! ( ss >> word ) )
+        {
+          continue;
+        }
+
+      if ( word == "repeat" )
+        {
+          long n;
+
+          if ( ! ( ss >> n ) || n < 1 || ss >> word )
+            {
+              return fail ( line, "repeat n" );
+            }
+          if ( repeats.size() == max_depth )
+            {
+              return fail ( line, "too deep repeats" );
+            }
+
+          repeats.emplace_back ( m_segments.size(), n );
+        }
+      else if ( word == "end" )
+        {
+          if ( repeats.empty() || ss >> word )
+            {
+              return fail ( line, "end without repeat" );
+            }
+
+          std::size_t first = repeats.back().first;
+          std::size_t n = m_segments.size() - first;
+
+          if ( n > 0 && static_cast<unsigned long> ( repeats.back().second - 1 )
+               > ( max_segments - m_segments.size() ) / n )
+            {
+              return fail ( line, "too many segments" );
+            }
+
+          for ( long k {1}; k<repeats.back().second; ++k )
+            for ( std::size_t i {0}; i<n; ++i )
+              {
+                m_segments.push_back ( m_segments[first+i] );
+              }
+
+          repeats.pop_back();
+        }
+      else
+        {
+          SamuSegment segment {SamuGenerator::EMPTY, 0, true};
+          std::string skip;
+
+          if ( !generator ( word, segment.generator ) )
+            {
+              return fail ( line, "unknown generator " + word );
+            }
+          if ( ! ( ss >> segment.duration ) || segment.duration < 1 )
+            {
+              return fail ( line, word + " ticks [skip]" );
+            }
+          if ( ss >> skip )
+            {
+              if ( skip != "skip" || ss >> word )
+                {
+                  return fail ( line, word + " ticks [skip]" );
+                }
+              segment.learning = false;
+            }
+          if ( m_segments.size() == max_segments )
+            {
+              return fail ( line, "too many segments" );
+            }
+
+          m_segments.push_back ( segment );
+        }
+    }
+
+  if ( !repeats.empty() )
+    {
+      return fail ( line, "repeat without end" );
+    }
+  if ( m_segments.empty() )
+    {
+      return fail ( line, "no segments" );
+    }
+
+  for ( const SamuSegment & segment : m_segments )
+    {
+      m_duration += segment.duration;
+    }
+
+  return true;
+}
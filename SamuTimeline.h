@@ -0,0 +1,97 @@
+#ifndef SamuTimeline_H
+#define SamuTimeline_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuTimeline.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The scenario timeline of GameOfLife (GameOfLife::setTimeline) instead of
+ * its fixed Conway, Stroop and Movie schedule. A timeline is a text file of
+ * segments, a segment is a generator of the reality and its duration in
+ * ticks, the segments can be repeated, and the whole timeline starts again
+ * at its end:
+ *
+ *     # the scenarios of the paper
+ *     gliders 1
+ *     conway 4998
+ *     repeat 3
+ *         stroop 180
+ *         movie 600 skip
+ *     end
+ *
+ * The generators are empty, gliders (the five gliders on an empty lattice),
+ * conway (the next generation of the previous reality), stroop and movie.
+ * The reality of a segment marked skip is generated but it is not learnt,
+ * so the uninteresting parts of an experiment are fast-forwarded.
+ */
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+enum class SamuGenerator : std::uint8_t {
+    EMPTY,
+    GLIDERS,
+    CONWAY,
+    STROOP,
+    MOVIE
+};
+
+struct SamuSegment {
+    SamuGenerator generator;
+    long duration;
+    bool learning;
+};
+
+class SamuTimeline
+{
+public:
+    bool load ( const char * path );
+    bool parse ( std::istream & in );
+
+    // the reason of the last failed load or parse, with its line
+    const std::string & error() const {
+        return m_error;
+    }
+
+    // the segments with the repeats unrolled
+    const std::vector<SamuSegment> & segments() const {
+        return m_segments;
+    }
+    // the ticks of a pass of the timeline
+    long duration() const {
+        return m_duration;
+    }
+
+private:
+    bool fail ( int line, const std::string & what );
+
+    std::vector<SamuSegment> m_segments;
+    long m_duration {0};
+    std::string m_error;
+};
+
+#endif
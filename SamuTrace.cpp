@@ -0,0 +1,361 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuTrace.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The rings of the threads, the background thread that writes the JSON
+ * and the formatting of the events.
+ */
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SamuRing.h"
+#include "SamuTrace.h"
+
+namespace
+{
+
+typedef SamuRing<SamuTraceEvent, 1u << 14> SamuTraceEvents;
+
+// the rings of the threads and the thread that writes their events
+class SamuTracer
+{
+public:
+  static SamuTracer & instance()
+  {
+    static SamuTracer tracer;
+    return tracer;
+  }
+
+  SamuTraceEvents * add ( int & tid )
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    rings.emplace_back ( new SamuTraceEvents );
+    tid = rings.size();
+
+    if ( file.is_open() )
+      {
+        thread_name ( tid );
+      }
+
+    return rings.back().get();
+  }
+
+  bool open ( const char * path )
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    end();
+
+    file.open ( path, std::ios::trunc );
+    if ( !file )
+      {
+        return false;
+      }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+         << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+         << "\"args\":{\"name\":\"SamuBrain\"}}";
+    for ( std::size_t tid {1}; tid <= rings.size(); ++tid )
+      {
+        thread_name ( tid );
+      }
+
+    if ( !thread.joinable() )
+      {
+        thread = std::thread ( &SamuTracer::run, this );
+      }
+
+    return static_cast<bool> ( file );
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lock ( mutex );
+
+    end();
+  }
+
+  ~SamuTracer()
+  {
+    running = false;
+    if ( thread.joinable() )
+      {
+        thread.join();
+      }
+
+    end();
+  }
+
+private:
+  void run()
+  {
+    while ( running )
+      {
+        std::size_t n;
+        {
+          std::lock_guard<std::mutex> lock ( mutex );
+          n = drain();
+        }
+
+        if ( !n )
+          {
+            std::this_thread::sleep_for ( std::chrono::milliseconds ( 1 ) );
+          }
+      }
+  }
+
+  // the caller holds the mutex (or it is the last one)
+  std::size_t drain()
+  {
+    std::size_t n {0};
+    SamuTraceEvent event;
+
+    for ( std::size_t i {0}; i<rings.size(); ++i )
+      while ( rings[i]->pop ( event ) )
+        {
+          if ( file.is_open() )
+            {
+              SamuTrace::write ( event, i+1, file );
+            }
+          ++n;
+        }
+
+    if ( n && file.is_open() )
+      {
+        file.flush();
+      }
+
+    return n;
+  }
+
+  void end()
+  {
+    drain();
+
+    if ( file.is_open() )
+      {
+        file << "\n]}\n";
+        file.close();
+      }
+  }
+
+  void thread_name ( int tid )
+  {
+    file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+         << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+  }
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<SamuTraceEvents>> rings;
+  std::ofstream file;
+  std::atomic<bool> running {true};
+  std::thread thread;
+};
+
+const char * counter_name ( SamuCounter c )
+{
+  static const char * names[static_cast<int> ( SamuCounter::NOF_COUNTERS )] =
+  {
+    "#MPUs", "convergence %"
+  };
+
+  return names[static_cast<int> ( c )];
+}
+
+const char * instant_name ( SamuEvent e )
+{
+  switch ( e )
+    {
+    case SamuEvent::NEW_MPU:
+      return "new MPU";
+    case SamuEvent::RECOGNIZED_MPU:
+      return "recognized MPU";
+    case SamuEvent::NEW_INPUT:
+      return "new input detected";
+    case SamuEvent::LEARNING_TIME:
+      return "learning time";
+    default:
+      return "event";
+    }
+}
+
+const char * monitor_name ( SamuMonitor m )
+{
+  switch ( m )
+    {
+    case SamuMonitor::TICK:
+      return "TICK";
+    case SamuMonitor::HABITUATION:
+      return "HABITUATION";
+    case SamuMonitor::SENSITIZATION:
+      return "SENSITIZATION";
+    case SamuMonitor::HIGHER_ORDER:
+      return "HIGHER-ORDER NOTION";
+    case SamuMonitor::MEMORY:
+      return "MEMORY";
+    default:
+      return "MONITOR";
+    }
+}
+
+// the names of the MPUs are "Foobar0 0x...", only \ and " must be escaped
+// (quotes: false for a part of a string)
+void quote ( const char * s, std::ostream & out, bool quotes = true )
+{
+  if ( quotes )
+    {
+      out << '"';
+    }
+  for ( ; *s; ++s )
+    {
+      if ( *s == '"' || *s == '\\' )
+        {
+          out << '\\';
+        }
+      out << *s;
+    }
+  if ( quotes )
+    {
+      out << '"';
+    }
+}
+
+// ns as us with three decimals
+void us ( std::int64_t ns, std::ostream & out )
+{
+  if ( ns < 0 )
+    {
+      out << '-';
+      ns = -ns;
+    }
+
+  char frac[4];
+  std::int64_t r = ns % 1000;
+  frac[0] = '0' + r / 100;
+  frac[1] = '0' + r / 10 % 10;
+  frac[2] = '0' + r % 10;
+  frac[3] = '\0';
+
+  out << ns / 1000 << '.' << frac;
+}
+
+}
+
+std::atomic<bool> & SamuTrace::tracing()
+{
+  static std::atomic<bool> t {false};
+  return t;
+}
+
+std::chrono::steady_clock::time_point & SamuTrace::origin()
+{
+  static std::chrono::steady_clock::time_point o {std::chrono::steady_clock::now() };
+  return o;
+}
+
+bool SamuTrace::open ( const char * path )
+{
+  tracing().store ( false, std::memory_order_release );
+
+  origin() = std::chrono::steady_clock::now();
+  bool ok = SamuTracer::instance().open ( path );
+
+  tracing().store ( ok, std::memory_order_release );
+
+  return ok;
+}
+
+void SamuTrace::close()
+{
+  if ( tracing().exchange ( false ) )
+    {
+      SamuTracer::instance().close();
+    }
+}
+
+void SamuTrace::push ( const SamuTraceEvent & event )
+{
+  static thread_local int tid;
+  static thread_local SamuTraceEvents * ring = SamuTracer::instance().add ( tid );
+
+  // the ring is full, waiting for the background thread
+  while ( !ring->push ( event ) )
+    {
+      std::this_thread::yield();
+    }
+}
+
+void SamuTrace::write ( const SamuTraceEvent & event, int tid, std::ostream & out )
+{
+  out << ",\n{\"ph\":\"" << event.ph << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+  us ( event.ts, out );
+
+  switch ( event.ph )
+    {
+    case 'X':
+      out << ",\"dur\":";
+      us ( event.dur, out );
+      out << ",\"cat\":\"phase\",\"name\":\""
+          << SamuProf::name ( static_cast<SamuPhase> ( event.id ) ) << "\"}";
+      break;
+    case 'i':
+    {
+      SamuEvent e = static_cast<SamuEvent> ( event.id );
+
+      out << ",\"s\":\"p\",\"cat\":\"" << monitor_name ( SamuLog::monitor ( e ) )
+          << "\",\"name\":\"" << instant_name ( e ) << "\",\"args\":{\"t\":" << event.clock;
+      if ( event.mpu[0] )
+        {
+          out << ",\"MPU\":";
+          quote ( event.mpu, out );
+        }
+      if ( e != SamuEvent::NEW_INPUT )
+        {
+          out << ( e == SamuEvent::LEARNING_TIME ? ",\"learning time\":" : ",\"searching time\":" )
+              << event.n;
+        }
+      out << "}}";
+      break;
+    }
+    case 'C':
+    {
+      const char * name = counter_name ( static_cast<SamuCounter> ( event.id ) );
+
+      // a track for each MPU
+      out << ",\"cat\":\"counter\",\"name\":\"" << name;
+      if ( event.mpu[0] )
+        {
+          out << ' ';
+          quote ( event.mpu, out, false );
+        }
+      out << "\",\"args\":{\"value\":" << event.value << "}}";
+      break;
+    }
+    }
+}
@@ -0,0 +1,160 @@
+#ifndef SamuTrace_H
+#define SamuTrace_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuTrace.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * A timeline of the ticks in the Chrome trace event format, it can be
+ * opened in chrome://tracing or in Perfetto (ui.perfetto.dev). It is off
+ * until SamuTrace::open is called (headless --trace file):
+ *
+ * - the phases of SAMU_PHASE are spans (DEFINES += SAMU_TRACE or
+ *   SAMU_PROFILE, without them the phases are not timed at all), except
+ *   the phases of the cells (ENCODING, QL) that would flood the timeline,
+ * - the SENSITIZATION and HIGHER-ORDER NOTION transitions of SamuBrain are
+ *   instant events,
+ * - #MPUs and the bogocertainty of convergence are counters.
+ *
+ * As the monitor stream, an event is a fixed size record put into the
+ * ring of the calling thread, a background thread formats the JSON.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include "SamuLog.h"
+#include "SamuProf.h"
+
+enum class SamuCounter : std::uint8_t {
+    MPUS,         // the number of the MPUs
+    CONVERGENCE,  // the bogocertainty of convergence of an MPU in %
+    NOF_COUNTERS
+};
+
+struct SamuTraceEvent {
+    std::int64_t ts;     // ns from SamuTrace::open
+    std::int64_t dur;    // ns, spans only
+    std::int64_t clock;
+    double value;        // counters only
+    std::int32_t n;
+    char ph;             // 'X': span, 'i': instant, 'C': counter
+    std::uint8_t id;     // SamuPhase, SamuEvent or SamuCounter
+    char mpu[26];
+};
+
+static_assert ( sizeof ( SamuTraceEvent ) == 64, "an event is a cache line" );
+
+class SamuTrace
+{
+public:
+    // the events are written into this file from now on
+    static bool open ( const char * path );
+    // it writes the rest of the events and the end of the JSON
+    static void close();
+
+    static bool on() {
+        return tracing().load ( std::memory_order_acquire );
+    }
+
+    static void span ( SamuPhase phase,
+                       std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end ) {
+        if ( !on() || phase == SamuPhase::ENCODING || phase == SamuPhase::QL ) {
+            return;
+        }
+
+        SamuTraceEvent event;
+        event.ts = ns ( start );
+        event.dur = ( end - start ).count();
+        event.clock = 0;
+        event.value = 0.0;
+        event.n = 0;
+        event.ph = 'X';
+        event.id = static_cast<std::uint8_t> ( phase );
+        event.mpu[0] = '\0';
+
+        push ( event );
+    }
+
+    static void instant ( SamuEvent e, long clock, const std::string & mpu = std::string(), int n = 0 ) {
+        if ( !on() ) {
+            return;
+        }
+
+        SamuTraceEvent event;
+        event.ts = ns ( std::chrono::steady_clock::now() );
+        event.dur = 0;
+        event.clock = clock;
+        event.value = 0.0;
+        event.n = n;
+        event.ph = 'i';
+        event.id = static_cast<std::uint8_t> ( e );
+        copy ( event, mpu );
+
+        push ( event );
+    }
+
+    // the series of a counter is named by the MPU (if any)
+    static void counter ( SamuCounter c, long clock, double value, const std::string & mpu = std::string() ) {
+        if ( !on() ) {
+            return;
+        }
+
+        SamuTraceEvent event;
+        event.ts = ns ( std::chrono::steady_clock::now() );
+        event.dur = 0;
+        event.clock = clock;
+        event.value = value;
+        event.n = 0;
+        event.ph = 'C';
+        event.id = static_cast<std::uint8_t> ( c );
+        copy ( event, mpu );
+
+        push ( event );
+    }
+
+    static void write ( const SamuTraceEvent & event, int tid, std::ostream & out );
+
+private:
+    static std::atomic<bool> & tracing();
+    static std::chrono::steady_clock::time_point & origin();
+
+    static std::int64_t ns ( std::chrono::steady_clock::time_point t ) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds> ( t - origin() ).count();
+    }
+
+    static void copy ( SamuTraceEvent & event, const std::string & mpu ) {
+        std::strncpy ( event.mpu, mpu.c_str(), sizeof ( event.mpu ) - 1 );
+        event.mpu[sizeof ( event.mpu ) - 1] = '\0';
+    }
+
+    static void push ( const SamuTraceEvent & event );
+};
+
+#endif
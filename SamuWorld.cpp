@@ -0,0 +1,225 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuWorld.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The seeding and the generations of the large worlds.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include "SamuWorld.h"
+
+namespace
+{
+
+const char * glider[] = {
+  ".#.",
+  "..#",
+  "###"
+};
+
+// the lightweight spaceship
+const char * spaceship[] = {
+  ".#..#",
+  "#....",
+  "#...#",
+  "####."
+};
+
+inline std::uint8_t rule ( std::uint8_t cell, int neighbours )
+{
+  return neighbours == 3 || ( cell && neighbours == 2 );
+}
+
+}
+
+bool SamuWorld::open ( const SamuWorldConfig & config )
+{
+  if ( config.w < 3 || config.h < 3
+       || config.soup < 0.0 || config.soup > 1.0
+       || config.gliders < 0.0 || config.spaceships < 0.0
+       || config.windowW < 0 || config.windowH < 0
+       || config.windowW > config.w || config.windowH > config.h )
+    {
+      return false;
+    }
+
+  m_w = config.w;
+  m_h = config.h;
+  bool window = config.windowW && config.windowH;
+
+  m_x = window ? ( ( config.x % m_w ) + m_w ) % m_w : 0;
+  m_y = window ? ( ( config.y % m_h ) + m_h ) % m_h : 0;
+  m_windowW = window ? config.windowW : m_w;
+  m_windowH = window ? config.windowH : m_h;
+
+  std::size_t n = static_cast<std::size_t> ( m_w ) *m_h;
+
+  cells.assign ( n, 0 );
+  nextCells.assign ( n, 0 );
+
+  frame.assign ( static_cast<std::size_t> ( m_windowW ) *m_windowH, 0 );
+  rows.resize ( m_windowH );
+  for ( int r {0}; r<m_windowH; ++r )
+    {
+      rows[r] = frame.data() + static_cast<std::size_t> ( r ) *m_windowW;
+    }
+
+  m_generations = 0;
+  m_generationMs = 0.0;
+
+  seed ( config );
+
+  return true;
+}
+
+void SamuWorld::seed ( const SamuWorldConfig & config )
+{
+  std::mt19937 rnd ( config.seed );
+
+  if ( config.soup > 0.0 )
+    {
+      std::bernoulli_distribution live ( config.soup );
+
+      for ( std::uint8_t & cell : cells )
+        {
+          cell = live ( rnd );
+        }
+    }
+
+  std::uniform_int_distribution<int> x ( 0, m_w-1 ), y ( 0, m_h-1 ), flip ( 0, 3 );
+  double area = static_cast<double> ( m_w ) *m_h / 10000.0;
+
+  for ( long k = std::lround ( config.gliders * area ); k > 0; --k )
+    {
+      int f = flip ( rnd );
+      put ( glider, 3, x ( rnd ), y ( rnd ), f & 1, f & 2 );
+    }
+
+  for ( long k = std::lround ( config.spaceships * area ); k > 0; --k )
+    {
+      int f = flip ( rnd );
+      put ( spaceship, 4, x ( rnd ), y ( rnd ), f & 1, f & 2 );
+    }
+}
+
+void SamuWorld::put ( const char * const * pattern, int ph, int x, int y, bool flipX, bool flipY )
+{
+  for ( int i {0}; i<ph; ++i )
+    {
+      const char * row = pattern[flipY ? ph-1-i : i];
+      int pw = std::char_traits<char>::length ( row );
+
+      for ( int j {0}; j<pw; ++j )
+        {
+          std::size_t r = ( y+i ) % m_h;
+          std::size_t c = ( x+j ) % m_w;
+
+          cells[r*m_w + c] = row[flipX ? pw-1-j : j] == '#';
+        }
+    }
+}
+
+bool SamuWorld::next()
+{
+  if ( m_generations )
+    {
+      auto begin = std::chrono::steady_clock::now();
+      generation();
+      std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - begin;
+      m_generationMs += d.count();
+    }
+
+  ++m_generations;
+
+  // the window wraps around the torus
+  for ( int r {0}; r<m_windowH; ++r )
+    {
+      const std::uint8_t * row = cells.data() + static_cast<std::size_t> ( ( m_y+r ) % m_h ) *m_w;
+      int * out = rows[r];
+      int c {0};
+
+      for ( int o = m_x; c<m_windowW && o<m_w; ++c, ++o )
+        {
+          out[c] = row[o];
+        }
+      for ( int o {0}; c<m_windowW; ++c, ++o )
+        {
+          out[c] = row[o];
+        }
+    }
+
+  return true;
+}
+
+void SamuWorld::generation()
+{
+  int w = m_w;
+  int h = m_h;
+  const std::uint8_t * now = cells.data();
+  std::uint8_t * next = nextCells.data();
+
+  #pragma omp parallel for
+  for ( int r = 0; r<h; ++r )
+    {
+      const std::uint8_t * up = now + static_cast<std::size_t> ( ( r+h-1 ) % h ) *w;
+      const std::uint8_t * mid = now + static_cast<std::size_t> ( r ) *w;
+      const std::uint8_t * down = now + static_cast<std::size_t> ( ( r+1 ) % h ) *w;
+      std::uint8_t * out = next + static_cast<std::size_t> ( r ) *w;
+
+      // the inner columns, vectorized (it is not at -O2 without simd)
+      #pragma omp simd
+      for ( int c = 1; c<w-1; ++c )
+        {
+          int n = up[c-1] + up[c] + up[c+1]
+                  + mid[c-1] + mid[c+1]
+                  + down[c-1] + down[c] + down[c+1];
+          out[c] = rule ( mid[c], n );
+        }
+
+      out[0] = rule ( mid[0], up[w-1] + up[0] + up[1]
+                      + mid[w-1] + mid[1]
+                      + down[w-1] + down[0] + down[1] );
+      out[w-1] = rule ( mid[w-1], up[w-2] + up[w-1] + up[0]
+                        + mid[w-2] + mid[0]
+                        + down[w-2] + down[w-1] + down[0] );
+    }
+
+  cells.swap ( nextCells );
+}
+
+std::uint64_t SamuWorld::population() const
+{
+  std::uint64_t n {0};
+
+  for ( std::uint8_t cell : cells )
+    {
+      n += cell;
+    }
+
+  return n;
+}
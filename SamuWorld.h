@@ -0,0 +1,115 @@
+#ifndef SamuWorld_H
+#define SamuWorld_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuWorld.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * A large world for the stress tests: a torus of Conway's Game of Life
+ * (e.g. 4096x4096) seeded with a random soup, gliders and lightweight
+ * spaceships, from a seed. The learner sees a window of the world (or the
+ * whole world), so the size of the world and the size of the learner can
+ * be scaled independently: the world is a SamuSource of the frames of its
+ * window.
+ *
+ * The cells are bytes, a generation is computed row by row in parallel
+ * (OpenMP) with the wrapped rows and columns at the edges only, and only
+ * the window is copied into the frame of the learner.
+ */
+
+#include <cstdint>
+#include <vector>
+#include "SamuSource.h"
+
+struct SamuWorldConfig {
+    int w {4096};
+    int h {4096};
+    unsigned seed {1};
+    // the probability of a live cell of the soup
+    double soup {0.0};
+    // the number of gliders and spaceships in each 10000 cells
+    double gliders {0.0};
+    double spaceships {0.0};
+    // the window of the learner, w or h 0 is the whole world
+    int x {0}, y {0};
+    int windowW {0}, windowH {0};
+};
+
+class SamuWorld : public SamuSource
+{
+public:
+    bool open ( const SamuWorldConfig & config );
+
+    // the size of the window
+    int getW() const override {
+        return m_windowW;
+    }
+    int getH() const override {
+        return m_windowH;
+    }
+
+    // the next generation, it never ends
+    bool next() override;
+
+    int ** lattice() override {
+        return rows.data();
+    }
+    long tick() const override {
+        return m_generations;
+    }
+
+    int getWorldW() const {
+        return m_w;
+    }
+    int getWorldH() const {
+        return m_h;
+    }
+    // the live cells of the world
+    std::uint64_t population() const;
+    // the time of the generations (without the copies of the window)
+    double generationMs() const {
+        return m_generationMs;
+    }
+
+private:
+    void seed ( const SamuWorldConfig & config );
+    void put ( const char * const * pattern, int ph, int x, int y, bool flipX, bool flipY );
+    void generation();
+
+    int m_w {0}, m_h {0};
+    int m_x {0}, m_y {0};
+    int m_windowW {0}, m_windowH {0};
+
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint8_t> nextCells;
+
+    std::vector<int> frame;
+    std::vector<int *> rows;
+
+    long m_generations {0};
+    double m_generationMs {0.0};
+};
+
+#endif
@@ -0,0 +1,376 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file KernelBench.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The micro-benchmarks of the hot kernels of a tick on the fixtures of a
+ * warmed-up brain: a GameOfLife is run in the Conway scenario, then its
+ * lattice, its current MPU (with the realistic sizes of its Q-tables,
+ * rules and perceptrons) and its habituation are measured in place:
+ *
+ * - GameOfLife::control_Conway and GameOfLife::numberOfNeighbors,
+ * - SamuBrain::encoding (the key of a cell in SamuBrain::pred),
+ * - QL::operator() of the cells (KernelBench: table, KernelBenchNN: NN),
+ * - Habituation::is_habituation,
+ * - the forward pass and the learning step of a QlPerceptron (NN).
+ *
+ * Where the hardware counters are available (SamuPerf), it also reports
+ * the IPC and the cache and branch misses per cell of each kernel.
+ *
+ * KernelBench [--width 34] [--height 16] [--warmup 3000] [--time ms]
+ *
+ * The results are written as JSON on the standard output, so two runs can
+ * be diffed or compared by a script.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "GameOfLife.h"
+#include "SamuPerf.h"
+
+SamuPerf & perf ( void )
+{
+  static SamuPerf p;
+  return p;
+}
+
+struct Result {
+  const char *name;
+  long ops;         // the number of the measured calls
+  double mean;      // ns per call
+  double min;       // ns per call in the fastest batch
+  int cells;        // the cells processed by a call
+  double counts[SamuPerf::NOF_COUNTERS];  // per call
+};
+
+// it repeats batches of f (f does ops calls) for at least ms milliseconds,
+// a batch takes at least 100 us, so the clock and the counters are negligible
+template <typename F>
+Result measure ( const char *name, int ops, int cells, double ms, F f )
+{
+  Result result {name, 0, 0.0, 1e300, cells, {}};
+  std::chrono::duration<double, std::nano> total {0};
+
+  // it is not measured, it warms up the caches
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double, std::nano> once = std::chrono::steady_clock::now() - start;
+  long reps = std::max ( 1l, ( long ) ( 1e5 / std::max ( once.count(), 1.0 ) ) );
+
+  while ( total.count() < ms * 1e6 )
+    {
+      perf().start();
+      start = std::chrono::steady_clock::now();
+      for ( long i {0}; i<reps; ++i )
+        {
+          f();
+        }
+      std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+      perf().stop ( result.counts );
+
+      total += d;
+      result.ops += ops*reps;
+      result.min = std::min ( result.min, d.count() / ( ops*reps ) );
+    }
+
+  result.mean = total.count() / result.ops;
+  for ( double & count : result.counts )
+    {
+      count /= result.ops;
+    }
+
+  return result;
+}
+
+// it sees the privates of GameOfLife, SamuBrain and QL
+class SamuBench
+{
+public:
+  SamuBench ( int w, int h, long warmup ) : w ( w ), h ( h ), warmup ( warmup ), life ( w, h ) {
+    SamuLog::setLevel ( SamuLevel::OFF );
+
+    for ( long t {0}; t<warmup; ++t )
+      {
+        life.step();
+      }
+
+    reality = life.lattice();
+    brain = life.getBrain();
+    morgan = brain->m_morgan;
+
+    SamuNeighbourhood & n = brain->m_neighbourhood;
+    int colors[SamuNeighbourhood::max_colors] {};
+    int window[SamuNeighbourhood::max_colors];
+    n.prepare ( reality, w, h );
+    for ( int r {0}; r<h; ++r )
+      for ( int c {0}; c<w; ++c )
+        {
+          prgs.push_back ( brain->encoding ( reality, r, c, window, colors ) );
+          // the image of the cell as SamuBrain::pred feeds it
+          occupied.push_back ( ( n.size()-colors[0] ) / static_cast<double> ( n.size() ) );
+        }
+  }
+
+  Result conway ( double ms ) {
+    int **next = life.lattices[ ( life.latticeIndex+1 ) %2];
+
+    return measure ( "GameOfLife::control_Conway", 1, w*h, ms, [&]
+    {
+      life.control_Conway ( reality, next );
+    } );
+  }
+
+  Result neighbors ( double ms ) {
+    return measure ( "GameOfLife::numberOfNeighbors", w*h, 1, ms, [&]
+    {
+      for ( int r {0}; r<h; ++r )
+        for ( int c {0}; c<w; ++c )
+          {
+            sink += life.numberOfNeighbors ( reality, r, c, true );
+          }
+    } );
+  }
+
+  Result encoding ( double ms ) {
+    int colors[SamuNeighbourhood::max_colors] {};
+    int window[SamuNeighbourhood::max_colors];
+
+    // with the prefix sums of the reality, once per pred
+    return measure ( "SamuBrain::encoding", w*h, 1, ms, [&]
+    {
+      brain->m_neighbourhood.prepare ( reality, w, h );
+      for ( int r {0}; r<h; ++r )
+        for ( int c {0}; c<w; ++c )
+          {
+            sink += brain->encoding ( reality, r, c, window, colors ).size();
+          }
+    } );
+  }
+
+  // the cells learn the same reality again and again
+  Result ql ( double ms ) {
+    MPU samuQl = morgan->getSamu();
+#ifndef Q_LOOKUP_TABLE
+    FrameStore & frames = morgan->getFrames();
+#endif
+
+    return measure ( "QL::operator()", w*h, 1, ms, [&]
+    {
+#ifndef Q_LOOKUP_TABLE
+      frames.next();
+#endif
+      for ( int r {0}; r<h; ++r )
+        for ( int c {0}; c<w; ++c )
+          {
+#ifdef Q_LOOKUP_TABLE
+            sink += samuQl[r][c] ( reality[r][c], prgs[r*w+c], true );
+#else
+            double *image = frames.image ( shared_image ? 0 : r*w+c );
+            if ( !shared_image )
+              {
+                image[0] = reality[r][c];
+                image[1] = occupied[r*w+c];
+              }
+            sink += samuQl[r][c] ( reality[r][c], prgs[r*w+c], image );
+#endif
+          }
+    } );
+  }
+
+  // the sums of a habituated MPU: all the living cells are predicted
+  Result habituation ( double ms ) {
+    Habituation habi = morgan->getHabituation();
+    int alive {0};
+    double mon;
+
+    for ( int r {0}; r<h; ++r )
+      for ( int c {0}; c<w; ++c )
+        {
+          alive += reality[r][c] != 0;
+        }
+
+    return measure ( "Habituation::is_habituation", 1, w*h, ms, [&]
+    {
+      sink += habi.is_habituation ( alive, alive, mon );
+    } );
+  }
+
+#if !defined ( Q_LOOKUP_TABLE ) && !defined ( SHARED_TRUNK )
+  // a perceptron of a cell, it learns its own output, so its weights do not change
+  std::vector<Result> perceptron ( double ms ) {
+    std::vector<Result> results;
+    QL & ql = morgan->getSamu() [h/2][w/2];
+
+    if ( ql.prcps.empty() )
+      {
+        return results;
+      }
+
+    QlPerceptron & p = *ql.prcps.begin()->second;
+    double image[2] = {1.0, 3/8.0};
+
+    results.push_back ( measure ( "Perceptron::operator()", 1, 1, ms, [&]
+    {
+      sink += p ( image );
+    } ) );
+
+    results.push_back ( measure ( "Perceptron::learning", 1, 1, ms, [&]
+    {
+      double q = p ( image );
+      p.learning ( image, q, q );
+    } ) );
+
+    return results;
+  }
+#endif
+
+  void fixture ( std::FILE *out ) {
+    SamuMemory m = morgan->memory();
+
+    std::fprintf ( out,
+                   "  \"mode\": \"%s\",\n"
+                   "  \"fixture\": {\"width\": %d, \"height\": %d, \"warmup\": %ld, \"MPUs\": %d,"
+                   " \"bytes\": %llu, \"table\": %llu, \"frqs\": %llu, \"rules\": %llu,"
+                   " \"tree\": %llu, \"perceptrons\": %llu},\n",
+#ifdef Q_LOOKUP_TABLE
+                   "table",
+#elif defined ( SHARED_TRUNK )
+                   "NN (shared trunk)",
+#else
+                   "NN",
+#endif
+                   w, h, warmup, brain->nofMPUs(),
+                   ( unsigned long long ) m.total(),
+                   ( unsigned long long ) m.entries[SamuMemory::TABLE],
+                   ( unsigned long long ) m.entries[SamuMemory::FRQS],
+                   ( unsigned long long ) m.entries[SamuMemory::RULES],
+                   ( unsigned long long ) m.entries[SamuMemory::TREE],
+                   ( unsigned long long ) m.entries[SamuMemory::PERCEPTRONS] );
+  }
+
+  volatile double sink {0.0};
+
+private:
+  int w, h;
+  long warmup;
+  GameOfLife life;
+  int **reality;
+  SamuBrain *brain;
+  MORGAN morgan;
+  std::vector<std::string> prgs;
+  std::vector<double> occupied;
+};
+
+void usage ( const char * name )
+{
+  std::fprintf ( stderr, "Usage: %s [--width w] [--height h] [--warmup n] [--time ms]\n", name );
+}
+
+int main ( int argc, char** argv )
+{
+  int w {34}, h {16};
+  long warmup {3000};
+  double ms {200.0};
+
+  for ( int i {1}; i<argc; ++i )
+    {
+      bool has_value = i+1 < argc;
+
+      if ( !std::strcmp ( argv[i], "--width" ) && has_value )
+        {
+          w = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--height" ) && has_value )
+        {
+          h = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--warmup" ) && has_value )
+        {
+          warmup = std::atol ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--time" ) && has_value )
+        {
+          ms = std::atof ( argv[++i] );
+        }
+      else
+        {
+          usage ( argv[0] );
+          return 1;
+        }
+    }
+
+  // the sprites of the Stroop and Movie scenarios
+  if ( w < 31 || h < 12 || warmup < 1 )
+    {
+      std::fprintf ( stderr, "The lattice must be at least 31x12.\n" );
+      return 1;
+    }
+
+  SamuBench bench ( w, h, warmup );
+
+  std::vector<Result> results;
+  results.push_back ( bench.conway ( ms ) );
+  results.push_back ( bench.neighbors ( ms ) );
+  results.push_back ( bench.encoding ( ms ) );
+  results.push_back ( bench.habituation ( ms ) );
+#if !defined ( Q_LOOKUP_TABLE ) && !defined ( SHARED_TRUNK )
+  for ( const Result & result : bench.perceptron ( ms ) )
+    {
+      results.push_back ( result );
+    }
+#endif
+  // it changes the MPU, so it is the last one
+  results.push_back ( bench.ql ( ms ) );
+
+  std::printf ( "{\n  \"bench\": \"KernelBench\",\n" );
+  bench.fixture ( stdout );
+  std::printf ( "  \"counters\": \"%s\",\n",
+                perf().available() ? "perf_event_open" : ( "unavailable: " + perf().why() ).c_str() );
+  std::printf ( "  \"results\": [\n" );
+  for ( std::size_t i {0}; i<results.size(); ++i )
+    {
+      const Result & r = results[i];
+
+      std::printf ( "    {\"name\": \"%s\", \"unit\": \"ns/op\", \"ops\": %ld, \"mean\": %.2f, \"min\": %.2f",
+                    r.name, r.ops, r.mean, r.min );
+      if ( perf().available() )
+        {
+          std::printf ( ", \"cycles\": %.1f, \"instructions\": %.1f, \"ipc\": %.3f,"
+                        " \"cache_misses_per_cell\": %.4f, \"branch_misses_per_cell\": %.4f",
+                        r.counts[SamuPerf::CYCLES], r.counts[SamuPerf::INSTRUCTIONS],
+                        r.counts[SamuPerf::CYCLES] > 0 ? r.counts[SamuPerf::INSTRUCTIONS] / r.counts[SamuPerf::CYCLES] : 0.0,
+                        r.counts[SamuPerf::CACHE_MISSES] / r.cells,
+                        r.counts[SamuPerf::BRANCH_MISSES] / r.cells );
+        }
+      std::printf ( "}%s\n", i+1 < results.size() ? "," : "" );
+    }
+  std::printf ( "  ]\n}\n" );
+
+  return 0;
+}
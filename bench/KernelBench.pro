@@ -0,0 +1,5 @@
+# QL with its lookup tables
+include(kernels.pri)
+
+TARGET = KernelBench
+DEFINES *= Q_LOOKUP_TABLE
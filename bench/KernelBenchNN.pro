@@ -0,0 +1,5 @@
+# QL with its NNs
+include(kernels.pri)
+
+TARGET = KernelBenchNN
+DEFINES -= Q_LOOKUP_TABLE
@@ -0,0 +1,363 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file PerceptronBench.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The runtime-sized Perceptron<> versus the compile-time sized
+ * Perceptron<Layers...> with the topologies of QL, with the exact and
+ * with the fast sigmoid.
+ *
+ * It also compares the fast sigmoid to the exact one: the maximal error,
+ * the learning curves of a 2-6-1 network and the habituation time of a
+ * QL (NN build) that learns a periodic input. It exits with 1 if a network
+ * does not learn or if the fast variant is out of tolerance.
+ *
+ * Finally, it compares the dense and the sparse input paths with images
+ * of 5% density. It exits with 1 if their results differ.
+ */
+
+#include <chrono>
+#include <numeric>
+#include <cstdio>
+#include <sstream>
+#include "SamuQl.h"
+
+template <typename F>
+double ns_per_op ( F f, int n )
+{
+  auto start = std::chrono::steady_clock::now();
+
+  for ( int i {0}; i<n; ++i )
+    {
+      f();
+    }
+
+  std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+
+  return d.count() / n;
+}
+
+template <typename Dynamic, typename Fixed>
+void bench ( const char *name, Dynamic & dynamic, Fixed & fixed, int inputs, int n )
+{
+  std::vector<double> image ( inputs );
+
+  std::default_random_engine gen;
+  std::bernoulli_distribution dist ( .2 );
+  for ( double & x : image )
+    {
+      x = dist ( gen );
+    }
+
+  volatile double sink {0.0};
+
+  double dynamic_f = ns_per_op ( [&]
+  {
+    sink = dynamic ( image.data() );
+  }, n );
+
+  double fixed_f = ns_per_op ( [&]
+  {
+    sink = fixed ( image.data() );
+  }, n );
+
+  double dynamic_l = ns_per_op ( [&]
+  {
+    double q = dynamic ( image.data() );
+    dynamic.learning ( image.data(), .5, q );
+  }, n );
+
+  double fixed_l = ns_per_op ( [&]
+  {
+    double q = fixed ( image.data() );
+    fixed.learning ( image.data(), .5, q );
+  }, n );
+
+  std::printf ( "%-18s %16.1f %16.1f %16.1f %16.1f\n",
+                name, dynamic_f, fixed_f, dynamic_l, fixed_l );
+}
+
+double max_error ( void )
+{
+  double max {0.0};
+
+  for ( double x {-50.0}; x <= 50.0; x += 1e-5 )
+    {
+      max = std::max ( max, std::fabs ( Sigmoid::approx ( x ) - Sigmoid::exact ( x ) ) );
+    }
+
+  return max;
+}
+
+// mean squared errors of a 2-6-1 network per 1000 learning steps, its last
+// unit learns y, so its output (the sigmoid of that unit) is compared to
+// the sigmoid of y
+std::vector<double> learning_curve ( bool fast )
+{
+  Sigmoid::fast() = fast;
+
+  Perceptron<2, 6, 1> p;
+  std::vector<double> curve;
+  double image[2];
+  double sse {0.0};
+
+  for ( int t {1}; t <= 30000; ++t )
+    {
+      image[0] = t%2;
+      image[1] = ( t/2 ) %3 / 2.0;
+      double y = .2 + .3*image[0] + .2*image[1];
+
+      double q = p ( image );
+      double e = q - Sigmoid::exact ( y );
+      sse += e*e;
+      p.learning ( image, y, q );
+
+      if ( t % 1000 == 0 )
+        {
+          curve.push_back ( sse/1000.0 );
+          sse = 0.0;
+        }
+    }
+
+  return curve;
+}
+
+// ticks until a QL (NN build) learning a periodic input reaches 95% of its
+// final rate of correct predictions, measured on a sliding window, and the
+// maximal Q of its last image in q
+int habituation_time ( bool fast, double & q )
+{
+  Sigmoid::fast() = fast;
+
+  const int ticks {6000}, window {300};
+
+  QL ql;
+  FrameStore frames ( 1, 2 );
+  std::vector<int> correct ( ticks );
+
+  for ( int t {0}; t < ticks; ++t )
+    {
+      SPOTriplet triplet = 1 + ( t % 3 );
+
+      std::stringstream ss;
+      ss << triplet;
+
+      double *image = frames.next();
+      image[0] = triplet / 3.0;
+      image[1] = ( t % 3 ) / 2.0;
+
+      ql ( triplet, ss.str(), image );
+      q = ql.max_ap_Q_sp_ap ( image );
+
+      correct[t] = ( ql.reward() == ql.get_max_reward() );
+    }
+
+  int final_rate = std::accumulate ( correct.end() - 1000, correct.end(), 0 ) * window / 1000;
+  int rate = std::accumulate ( correct.begin(), correct.begin() + window, 0 );
+
+  for ( int t {window}; t < ticks; ++t )
+    {
+      if ( rate >= .95 * final_rate )
+        {
+          return t;
+        }
+
+      rate += correct[t] - correct[t-window];
+    }
+
+  return -1;
+}
+
+int accuracy ( void )
+{
+  double error = max_error();
+
+  std::vector<double> exact_curve = learning_curve ( false );
+  std::vector<double> fast_curve = learning_curve ( true );
+
+  // relative to the exact curve
+  double curve_diff {0.0};
+  for ( std::size_t i {0}; i < exact_curve.size(); ++i )
+    {
+      curve_diff = std::max ( curve_diff, std::fabs ( exact_curve[i] - fast_curve[i] ) / exact_curve[i] );
+    }
+
+  double exact_q, fast_q;
+  int exact_habi = habituation_time ( false, exact_q );
+  int fast_habi = habituation_time ( true, fast_q );
+
+  // both networks must learn, the errors fall by 10x at least
+  bool ok = error < 3.7e-5
+            && exact_curve.back() * 10.0 < exact_curve.front()
+            && fast_curve.back() * 10.0 < fast_curve.front()
+            && curve_diff < 1e-1
+            && std::fabs ( exact_q - fast_q ) < 1e-2
+            && exact_habi != -1
+            && std::abs ( exact_habi - fast_habi ) <= std::max ( 100, exact_habi/10 );
+
+  std::printf ( "\nmax |approx-exact|: %g\n", error );
+  std::printf ( "learning curve MSE: exact %g -> %g, fast %g -> %g, max rel diff %g\n",
+                exact_curve.front(), exact_curve.back(),
+                fast_curve.front(), fast_curve.back(), curve_diff );
+  std::printf ( "QL habituation time: exact %d, fast %d\n", exact_habi, fast_habi );
+  std::printf ( "QL max Q: exact %g, fast %g, diff %g\n", exact_q, fast_q, std::fabs ( exact_q - fast_q ) );
+  std::printf ( "fast sigmoid: %s\n", ok ? "within tolerance" : "OUT OF TOLERANCE" );
+
+  return ok ? 0 : 1;
+}
+
+void sigmoid_throughput ( void )
+{
+  std::vector<double> z ( 1024 ), x ( z.size() );
+
+  for ( std::size_t i {0}; i < z.size(); ++i )
+    {
+      z[i] = -8.0 + 16.0*i/z.size();
+    }
+
+  for ( bool fast : {false, true} )
+    {
+      Sigmoid::fast() = fast;
+
+      double ns = ns_per_op ( [&]
+      {
+        x = z;
+        Sigmoid::apply ( x.data(), x.size() );
+      }, 10000 ) / x.size();
+
+      std::printf ( "Sigmoid::apply ( layer ) %-6s %8.2f ns/unit\n", fast ? "fast" : "exact", ns );
+    }
+}
+
+// the same network with the dense and with the sparse input path
+template <typename Dynamic, typename Fixed>
+bool sparse_input ( const char *name, int inputs, int n )
+{
+  Dynamic dense_dynamic, sparse_dynamic;
+  Fixed *dense_fixed = new Fixed, *sparse_fixed = new Fixed;
+
+  std::vector<std::vector<double>> images ( 16, std::vector<double> ( inputs ) );
+
+  std::default_random_engine gen;
+  std::bernoulli_distribution dist ( .05 );
+  for ( std::vector<double> & image : images )
+    for ( double & x : image )
+      {
+        x = dist ( gen );
+      }
+
+  double density = SparseInput::density();
+  bool same {true};
+  double ns[4];
+
+  for ( int sparse {0}; sparse < 2; ++sparse )
+    {
+      SparseInput::density() = sparse ? density : 0.0;
+
+      Dynamic & dynamic = sparse ? sparse_dynamic : dense_dynamic;
+      Fixed & fixed = sparse ? *sparse_fixed : *dense_fixed;
+      int i {0};
+
+      ns[2*sparse] = ns_per_op ( [&]
+      {
+        double * image = images[i++ % images.size()].data();
+        double q = dynamic ( image );
+        dynamic.learning ( image, .5, q );
+      }, n );
+
+      i = 0;
+      ns[2*sparse+1] = ns_per_op ( [&]
+      {
+        double * image = images[i++ % images.size()].data();
+        double q = fixed ( image );
+        fixed.learning ( image, .5, q );
+      }, n );
+    }
+
+  SparseInput::density() = density;
+
+  for ( std::vector<double> & image : images )
+    {
+      same = same
+             && dense_dynamic ( image.data() ) == sparse_dynamic ( image.data() )
+             && ( *dense_fixed ) ( image.data() ) == ( *sparse_fixed ) ( image.data() );
+    }
+
+  std::printf ( "%-18s %16.1f %16.1f %16.1f %16.1f %s\n",
+                name, ns[0], ns[2], ns[1], ns[3], same ? "same" : "DIFFERENT" );
+
+  delete dense_fixed;
+  delete sparse_fixed;
+
+  return same;
+}
+
+struct Perceptron800 : Perceptron<> {
+  Perceptron800() : Perceptron<> ( 3, 10*80, 32, 1 ) {}
+};
+
+struct Perceptron3200 : Perceptron<> {
+  Perceptron3200() : Perceptron<> ( 3, 2*10*2*80, 32, 1 ) {}
+};
+
+int main()
+{
+  std::printf ( "%-18s %16s %16s %16s %16s\n",
+                "topology", "Perceptron<> ns", "Perceptron<L> ns",
+                "<> learn ns", "<L> learn ns" );
+
+  for ( bool fast : {false, true} )
+    {
+      Sigmoid::fast() = fast;
+
+      std::printf ( "%s sigmoid\n", fast ? "fast" : "exact" );
+      {
+        Perceptron<> dynamic ( 3, 2, 6, 1 );
+        Perceptron<2, 6, 1> fixed;
+        bench ( "2-6-1", dynamic, fixed, 2, 1000000 );
+      }
+      {
+        Perceptron<> dynamic ( 5, 10*3, 16, 8, 4, 1 );
+        Perceptron<10*3, 16, 8, 4, 1> fixed;
+        bench ( "30-16-8-4-1", dynamic, fixed, 10*3, 100000 );
+      }
+      {
+        Perceptron<> dynamic ( 3, 10*80, 32, 1 );
+        Perceptron<10*80, 32, 1> *fixed = new Perceptron<10*80, 32, 1>;
+        bench ( "800-32-1", dynamic, *fixed, 10*80, 2000 );
+        delete fixed;
+      }
+    }
+
+  sigmoid_throughput();
+
+  std::printf ( "\n%-18s %16s %16s %16s %16s\n",
+                "5% density", "<> dense ns", "<> sparse ns",
+                "<L> dense ns", "<L> sparse ns" );
+
+  bool same = sparse_input<Perceptron800, Perceptron<10*80, 32, 1>> ( "800-32-1", 10*80, 2000 );
+  same = sparse_input<Perceptron3200, Perceptron<2*10*2*80, 32, 1>> ( "3200-32-1", 2*10*2*80, 500 ) && same;
+
+  return accuracy() || !same;
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = PerceptronBench
+QT =
+CONFIG += c++14 console
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -fopenmp -fno-trapping-math
+LIBS += -fopenmp
+INCLUDEPATH += ..
+
+# QL with its NN and the same initial weights in every run
+DEFINES += LIFEOFGAME RND_DEBUG
+
+HEADERS += ../SamuJournal.h ../SamuSnapshot.h ../SamuQl.h
+SOURCES += PerceptronBench.cpp
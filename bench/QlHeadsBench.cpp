@@ -0,0 +1,146 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file QlHeadsBench.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Per-action perceptrons versus the shared-trunk multi-head network
+ * (SHARED_TRUNK) of QL, with the LIFEOFGAME (2-6-1) and the
+ * CHARACTER_CONSOLE (800-32-1) topologies.
+ *
+ * It measures the cost of evaluating all the Q(s', a') values of a state
+ * and the cost of a single learning step.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include "SamuQl.h"
+
+struct Topology {
+  const char *name;
+  int inputs;
+  int hidden;
+};
+
+template <typename F>
+double ns_per_op ( F f, int n )
+{
+  auto start = std::chrono::steady_clock::now();
+
+  for ( int i {0}; i<n; ++i )
+    {
+      f();
+    }
+
+  std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+
+  return d.count() / n;
+}
+
+void bench ( const Topology & topology, int nof_actions, int n )
+{
+  std::vector<double> image ( topology.inputs );
+
+  std::default_random_engine gen;
+  std::bernoulli_distribution dist ( .2 );
+  for ( double & x : image )
+    {
+      x = dist ( gen );
+    }
+
+  std::vector<Perceptron<>*> prcps;
+  MultiHeadPerceptron trunk ( 2, topology.inputs, topology.hidden );
+
+  for ( int a {0}; a<nof_actions; ++a )
+    {
+      prcps.push_back ( new Perceptron<> ( 3, topology.inputs, topology.hidden, 1 ) );
+      trunk.add ( a );
+    }
+
+  volatile double sink {0.0};
+
+  double prcps_q = ns_per_op ( [&]
+  {
+    double max = -std::numeric_limits<double>::max();
+    for ( Perceptron<> * p : prcps )
+      {
+        max = std::max ( max, ( *p ) ( image.data() ) );
+      }
+    sink = max;
+  }, n );
+
+  double trunk_q = ns_per_op ( [&]
+  {
+    const std::vector<double> & q = trunk ( image.data() );
+    sink = *std::max_element ( q.begin(), q.end() );
+  }, n );
+
+  double prcps_l = ns_per_op ( [&]
+  {
+    double q = ( *prcps[0] ) ( image.data() );
+    prcps[0]->learning ( image.data(), .5, q );
+  }, n );
+
+  double trunk_l = ns_per_op ( [&]
+  {
+    trunk ( image.data(), 0 );
+    trunk.learning ( image.data(), 0, .5 );
+  }, n );
+
+  std::size_t prcps_w = nof_actions * ( ( std::size_t ) topology.inputs*topology.hidden + topology.hidden );
+
+  std::printf ( "%-18s %4d %14.1f %14.1f %14.1f %14.1f %12zu %12zu\n",
+                topology.name, nof_actions,
+                prcps_q, trunk_q, prcps_l, trunk_l,
+                prcps_w, trunk.n_weights() );
+
+  for ( Perceptron<> * p : prcps )
+    {
+      delete p;
+    }
+}
+
+int main()
+{
+  Topology topologies[] =
+  {
+    {"LIFEOFGAME", 2, 6},
+    {"CHARACTER_CONSOLE", 10*80, 32}
+  };
+
+  int actions[] = {2, 5, 16, 64};
+
+  std::printf ( "%-18s %4s %14s %14s %14s %14s %12s %12s\n",
+                "topology", "#a",
+                "prcps Q ns", "trunk Q ns", "prcps learn ns", "trunk learn ns",
+                "prcps #w", "trunk #w" );
+
+  for ( const Topology & topology : topologies )
+    for ( int a : actions )
+      {
+        bench ( topology, a, topology.inputs > 100 ? 200 : 20000 );
+      }
+
+  return 0;
+}
@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = QlHeadsBench
+QT =
+CONFIG += c++14 console
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -fopenmp -fno-trapping-math
+LIBS += -fopenmp
+INCLUDEPATH += ..
+
+HEADERS += ../SamuJournal.h ../SamuSnapshot.h ../SamuQl.h
+SOURCES += QlHeadsBench.cpp
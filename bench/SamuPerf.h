@@ -0,0 +1,148 @@
+#ifndef SamuPerf_H
+#define SamuPerf_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file SamuPerf.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The hardware performance counters of the calling thread (Linux
+ * perf_event_open): cycles, instructions, cache misses and branch misses
+ * as one group, so they are scheduled together. They are not available
+ * everywhere (virtual machines, containers, perf_event_paranoid > 2),
+ * then available() is false and the benchmarks report wall time only.
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class SamuPerf
+{
+public:
+    enum Counter {CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, NOF_COUNTERS};
+
+    SamuPerf() {
+#ifdef __linux__
+        const std::uint64_t configs[NOF_COUNTERS] {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for ( int c {0}; c<NOF_COUNTERS; ++c ) {
+            perf_event_attr attr;
+            std::memset ( &attr, 0, sizeof ( attr ) );
+            attr.size = sizeof ( attr );
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[c];
+            attr.disabled = c == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            fds[c] = syscall ( __NR_perf_event_open, &attr, 0, -1, c ? fds[0] : -1, 0 );
+            if ( fds[c] < 0 ) {
+                error = std::strerror ( errno );
+                close();
+                return;
+            }
+        }
+#else
+        error = "perf_event_open is Linux only";
+#endif
+    }
+
+    ~SamuPerf() {
+        close();
+    }
+
+    bool available() const {
+        return fds[0] >= 0;
+    }
+
+    // why it is not available
+    const std::string & why() const {
+        return error;
+    }
+
+    void start() {
+#ifdef __linux__
+        if ( available() ) {
+            ioctl ( fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+        }
+#endif
+    }
+
+    // it adds the counts since start (scaled if the group was multiplexed)
+    void stop ( double counts[NOF_COUNTERS] ) {
+#ifdef __linux__
+        if ( !available() ) {
+            return;
+        }
+
+        ioctl ( fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP );
+
+        // nr, time enabled, time running, the values
+        std::uint64_t data[3+NOF_COUNTERS];
+        if ( read ( fds[0], data, sizeof ( data ) ) != sizeof ( data ) ) {
+            return;
+        }
+        ioctl ( fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+
+        double scale = data[2] ? ( double ) data[1] / data[2] : 1.0;
+        for ( int c {0}; c<NOF_COUNTERS; ++c ) {
+            counts[c] += data[3+c] * scale;
+        }
+#else
+        ( void ) counts;
+#endif
+    }
+
+private:
+    SamuPerf ( const SamuPerf & );
+    SamuPerf & operator= ( const SamuPerf & );
+
+    void close() {
+#ifdef __linux__
+        for ( int c {NOF_COUNTERS-1}; c >= 0; --c ) {
+            if ( fds[c] >= 0 ) {
+                ::close ( fds[c] );
+                fds[c] = -1;
+            }
+        }
+#endif
+    }
+
+    int fds[NOF_COUNTERS] {-1, -1, -1, -1};
+    std::string error;
+};
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file ScalingBench.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The scaling of a tick: a matrix of lattice sizes, numbers of pre-learned
+ * MPUs and numbers of threads. For each lattice, number of MPUs and number
+ * of threads a fresh brain is warmed up in the Conway scenario (3000 ticks
+ * by default, so the MPUs have learnt, each MPU learns the same ticks) and
+ * it measures
+ *
+ * - the latency of GameOfLife::step (mean and max),
+ * - the latency of a search pass, SamuBrain::pred with all the MPUs,
+ * - the memory of the brain (SamuBrain::memory) and the peak RSS.
+ *
+ * ScalingBench [--sizes 34x16,64x64,128x128,256x256] [--mpus 1,2,4]
+ *              [--threads 1,2,4] [--warmup 3000] [--ticks 20]
+ *
+ * It writes a CSV on the standard output, the warmup is a column of it. A
+ * learnt MPU needs some kB per cell, so a 1024x1024 lattice needs GBs of
+ * memory for each MPU:
+ *
+ * ScalingBench --sizes 256x256,512x512,1024x1024 --mpus 1,2 > scaling.csv
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include <sys/resource.h>
+#include "GameOfLife.h"
+
+// "34x16,64x64" or "1,2,4"
+std::vector<int> parse_list ( const char * list, char sep, bool pairs )
+{
+  std::vector<int> values;
+  std::stringstream ss ( list );
+  std::string item;
+
+  while ( std::getline ( ss, item, ',' ) )
+    {
+      std::size_t x = item.find ( sep );
+      if ( pairs && x == std::string::npos )
+        {
+          return std::vector<int>();
+        }
+      values.push_back ( std::atoi ( item.c_str() ) );
+      if ( pairs )
+        {
+          values.push_back ( std::atoi ( item.c_str() + x+1 ) );
+        }
+    }
+
+  return values;
+}
+
+double peak_rss_mb ( void )
+{
+  struct rusage usage;
+  getrusage ( RUSAGE_SELF, &usage );
+
+  return usage.ru_maxrss / 1024.0;
+}
+
+// it sees the privates of SamuBrain
+class SamuBench
+{
+public:
+  SamuBench ( int w, int h, int mpus, long warmup ) : life ( w, h ) {
+    brain = life.getBrain();
+
+    for ( int m {1}; m<mpus; ++m )
+      {
+        extra.push_back ( brain->newMPU() );
+      }
+
+    for ( long t {0}; t<warmup; ++t )
+      {
+        life.step();
+
+        int vsum;
+        for ( MORGAN morgan : extra )
+          {
+            brain->pred ( morgan, life.lattice(), life.getPredictions(), 0, vsum );
+          }
+      }
+  }
+
+  double step() {
+    auto start = std::chrono::steady_clock::now();
+    life.step();
+    std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+
+    return d.count();
+  }
+
+  // the MPU search loop of SamuBrain::learning
+  double search() {
+    int vsum;
+    auto start = std::chrono::steady_clock::now();
+    for ( auto & mpu : brain->m_brain )
+      {
+        brain->pred ( mpu.second, life.lattice(), life.getPredictions(), 4, vsum );
+      }
+    std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+
+    return d.count();
+  }
+
+  std::uint64_t bytes() const {
+    return brain->memory().total();
+  }
+
+  int nofMPUs() const {
+    return brain->nofMPUs();
+  }
+
+private:
+  GameOfLife life;
+  SamuBrain *brain;
+  std::vector<MORGAN> extra;
+};
+
+void usage ( const char * name )
+{
+  std::fprintf ( stderr,
+                 "Usage: %s [--sizes wxh,...] [--mpus n,...] [--threads n,...]"
+                 " [--warmup n] [--ticks n]\n",
+                 name );
+}
+
+int main ( int argc, char** argv )
+{
+  std::vector<int> sizes {34, 16, 64, 64, 128, 128, 256, 256};
+  std::vector<int> mpus {1, 2, 4};
+  std::vector<int> threads {1, 2, 4};
+  // the MPUs have learnt their inputs, as in KernelBench
+  long warmup {3000};
+  int ticks {20};
+
+  for ( int i {1}; i<argc; ++i )
+    {
+      bool has_value = i+1 < argc;
+
+      if ( !std::strcmp ( argv[i], "--sizes" ) && has_value )
+        {
+          sizes = parse_list ( argv[++i], 'x', true );
+        }
+      else if ( !std::strcmp ( argv[i], "--mpus" ) && has_value )
+        {
+          mpus = parse_list ( argv[++i], ',', false );
+        }
+      else if ( !std::strcmp ( argv[i], "--threads" ) && has_value )
+        {
+          threads = parse_list ( argv[++i], ',', false );
+        }
+      else if ( !std::strcmp ( argv[i], "--warmup" ) && has_value )
+        {
+          warmup = std::atol ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--ticks" ) && has_value )
+        {
+          ticks = std::atoi ( argv[++i] );
+        }
+      else
+        {
+          usage ( argv[0] );
+          return 1;
+        }
+    }
+
+  for ( std::size_t s {0}; s<sizes.size(); s+=2 )
+    {
+      if ( sizes[s] < 31 || sizes[s+1] < 12 )
+        {
+          std::fprintf ( stderr, "The lattice must be at least 31x12.\n" );
+          return 1;
+        }
+    }
+
+  if ( sizes.empty() || mpus.empty() || threads.empty() || ticks < 1
+       || *std::min_element ( mpus.begin(), mpus.end() ) < 1
+       || *std::min_element ( threads.begin(), threads.end() ) < 1 )
+    {
+      usage ( argv[0] );
+      return 1;
+    }
+
+  SamuLog::setLevel ( SamuLevel::OFF );
+
+  std::printf ( "width,height,cells,mpus,threads,warmup,step_ms,step_max_ms,search_ms,search_ms_per_mpu,"
+                "brain_bytes,bytes_per_cell,peak_rss_mb\n" );
+
+  for ( std::size_t s {0}; s<sizes.size(); s+=2 )
+    for ( int m : mpus )
+      {
+        int w = sizes[s], h = sizes[s+1];
+
+        for ( int t : threads )
+          {
+            // each row starts from the same warmed up brain
+            omp_set_num_threads ( *std::max_element ( threads.begin(), threads.end() ) );
+            SamuBench bench ( w, h, m, warmup );
+            std::uint64_t bytes = bench.bytes();
+
+            omp_set_num_threads ( t );
+
+            double sum {0.0}, max {0.0};
+            for ( int i {0}; i<ticks; ++i )
+              {
+                double d = bench.step();
+                sum += d;
+                max = std::max ( max, d );
+              }
+
+            double search = bench.search();
+
+            std::printf ( "%d,%d,%ld,%d,%d,%ld,%.3f,%.3f,%.3f,%.3f,%llu,%.1f,%.1f\n",
+                          w, h, ( long ) w*h, bench.nofMPUs(), t, warmup,
+                          sum / ticks, max, search, search / bench.nofMPUs(),
+                          ( unsigned long long ) bytes, ( double ) bytes / ( w*h ),
+                          peak_rss_mb() );
+            std::fflush ( stdout );
+          }
+      }
+
+  return 0;
+}
@@ -0,0 +1,5 @@
+# A tick on larger lattices with more MPUs and threads (CSV)
+include(core.pri)
+
+TARGET = ScalingBench
+SOURCES += ScalingBench.cpp
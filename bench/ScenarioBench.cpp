@@ -0,0 +1,347 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file ScenarioBench.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The macro-benchmark of the whole experiment: a headless brain is driven
+ * through the Conway, Stroop and Movie scenarios of GameOfLife::development
+ * (5000, 13000, 22000 by default) and it measures
+ *
+ * - the ticks/sec of each scenario and of the whole run,
+ * - the ticks spent by searching the MPUs (all, the number of the searches
+ *   and the longest one),
+ * - the number of the MPUs created and the peak RSS,
+ * - built with SAMU_ALLOC, the heap allocations of a tick and of a
+ *   steady-state tick (the MPU has learnt before and after it), their
+ *   phases are written on the standard error. With --assert-no-alloc it
+ *   fails (exit status 2) if a steady-state tick allocates anything.
+ *
+ * The metrics are written as JSON on the standard output and compared to
+ * a baseline (a flat JSON object of the same metrics, the one in the repo
+ * is scenario_baseline.json): a metric that is worse than the baseline by
+ * more than the threshold (10% by default) is a regression, they are
+ * listed on the standard error and the exit status is 1. Without a
+ * readable baseline it exits with 1 before the run unless --write-baseline
+ * is given. The default baseline is the one in the source directory.
+ *
+ * ScenarioBench [--width 34] [--height 16] [--schedule 5000,13000,22000]
+ *               [--threads n] [--baseline file] [--threshold 0.1]
+ *               [--write-baseline file] [--assert-no-alloc]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include <sys/resource.h>
+#include "GameOfLife.h"
+#include "SamuAlloc.h"
+
+struct Metric {
+  std::string name;
+  double value;
+  // 1: higher is better, -1: lower is better, 0: any change is suspicious
+  int better;
+};
+
+// the MB of the peak resident set size (Linux)
+double peak_rss_mb ( void )
+{
+  struct rusage usage;
+  getrusage ( RUSAGE_SELF, &usage );
+
+  return usage.ru_maxrss / 1024.0;
+}
+
+// "name": value pairs of a flat JSON object, false if there are none
+bool read_baseline ( const char * path, std::vector<Metric> & baseline )
+{
+  std::ifstream in ( path );
+  if ( !in )
+    {
+      return false;
+    }
+
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string json = ss.str();
+
+  for ( std::size_t q = json.find ( '"' ); q != std::string::npos; q = json.find ( '"', q ) )
+    {
+      std::size_t e = json.find ( '"', q+1 );
+      std::size_t colon = json.find ( ':', e );
+      if ( e == std::string::npos || colon == std::string::npos )
+        {
+          break;
+        }
+
+      baseline.push_back ( Metric {json.substr ( q+1, e-q-1 ), std::atof ( json.c_str() + colon+1 ), 0} );
+      q = json.find_first_of ( ",}", colon );
+    }
+
+  return !baseline.empty();
+}
+
+void write_metrics ( const std::vector<Metric> & metrics, std::ostream & out, const char * indent )
+{
+  out << "{\n";
+  for ( std::size_t i {0}; i<metrics.size(); ++i )
+    {
+      out << indent << "  \"" << metrics[i].name << "\": " << metrics[i].value
+          << ( i+1 < metrics.size() ? ",\n" : "\n" );
+    }
+  out << indent << "}";
+}
+
+void usage ( const char * name )
+{
+  std::fprintf ( stderr,
+                 "Usage: %s [--width w] [--height h] [--schedule conway,stroop,movie]"
+                 " [--threads n] [--baseline file] [--threshold t] [--write-baseline file]"
+                 " [--assert-no-alloc]\n",
+                 name );
+}
+
+// the path of bench/scenario_baseline.json, see ScenarioBench.pro
+#ifndef SCENARIO_BASELINE
+#define SCENARIO_BASELINE "scenario_baseline.json"
+#endif
+
+int main ( int argc, char** argv )
+{
+  int w {34}, h {16};
+  long schedule[3] {5000, 13000, 22000};
+  int threads {0};
+  const char * baseline_path {SCENARIO_BASELINE};
+  const char * write_path {nullptr};
+  double threshold {.1};
+  bool assert_no_alloc {false};
+
+  for ( int i {1}; i<argc; ++i )
+    {
+      bool has_value = i+1 < argc;
+
+      if ( !std::strcmp ( argv[i], "--width" ) && has_value )
+        {
+          w = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--height" ) && has_value )
+        {
+          h = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--schedule" ) && has_value )
+        {
+          if ( std::sscanf ( argv[++i], "%ld,%ld,%ld", &schedule[0], &schedule[1], &schedule[2] ) != 3
+               || ! ( 0 < schedule[0] && schedule[0] <= schedule[1] && schedule[1] <= schedule[2] ) )
+            {
+              usage ( argv[0] );
+              return 1;
+            }
+        }
+      else if ( !std::strcmp ( argv[i], "--threads" ) && has_value )
+        {
+          threads = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--baseline" ) && has_value )
+        {
+          baseline_path = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--threshold" ) && has_value )
+        {
+          threshold = std::atof ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--write-baseline" ) && has_value )
+        {
+          write_path = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--assert-no-alloc" ) )
+        {
+          assert_no_alloc = true;
+        }
+      else
+        {
+          usage ( argv[0] );
+          return 1;
+        }
+    }
+
+  if ( w < 31 || h < 12 )
+    {
+      std::fprintf ( stderr, "The lattice must be at least 31x12.\n" );
+      return 1;
+    }
+
+  std::vector<Metric> baseline;
+
+  if ( !write_path && !read_baseline ( baseline_path, baseline ) )
+    {
+      std::fprintf ( stderr, "Cannot read the baseline %s, write one with --write-baseline.\n", baseline_path );
+      return 1;
+    }
+
+  if ( assert_no_alloc && !SamuAlloc::counting() )
+    {
+      std::fprintf ( stderr, "The allocations are not counted, build with DEFINES += SAMU_ALLOC.\n" );
+      return 1;
+    }
+
+  if ( threads > 0 )
+    {
+      omp_set_num_threads ( threads );
+    }
+
+  SamuLog::setLevel ( SamuLevel::OFF );
+
+  GameOfLife gameOfLife ( w, h );
+  gameOfLife.setSchedule ( schedule[0], schedule[1], schedule[2] );
+  SamuBrain * brain = gameOfLife.getBrain();
+
+  const char * scenarios[3] {"conway", "stroop", "movie"};
+  double seconds[3] {0.0, 0.0, 0.0};
+  long ticks[3] {0, 0, 0};
+  long searching {0}, searches {0}, longest {0}, search {0};
+  SamuAllocs allocs, steady_allocs;
+  long steady {0}, first_alloc {0};
+
+  // the tick t is in the Conway scenario while t < schedule[0] etc.
+  for ( long t {1}; t <= schedule[2]; ++t )
+    {
+      int s = t < schedule[0] ? 0 : t < schedule[1] ? 1 : 2;
+
+      bool habituated = brain->haveAlreadyLearnt();
+      SamuAllocs before = SamuAlloc::snapshot();
+
+      auto start = std::chrono::steady_clock::now();
+      gameOfLife.step();
+      std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+
+      seconds[s] += d.count();
+      ++ticks[s];
+
+      SamuAllocs tick = SamuAlloc::snapshot() - before;
+      allocs += tick;
+
+      if ( habituated && brain->haveAlreadyLearnt() )
+        {
+          ++steady;
+          steady_allocs += tick;
+          if ( tick.total() && !first_alloc )
+            {
+              first_alloc = t;
+            }
+        }
+
+      if ( brain->isSearching() )
+        {
+          if ( !search++ )
+            {
+              ++searches;
+            }
+          ++searching;
+          longest = std::max ( longest, search );
+        }
+      else
+        {
+          search = 0;
+        }
+    }
+
+  std::vector<Metric> metrics;
+  double all {0.0};
+  for ( int s {0}; s<3; ++s )
+    {
+      metrics.push_back ( Metric {std::string ( scenarios[s] ) + " ticks/sec",
+                                  seconds[s] > 0 ? ticks[s] / seconds[s] : 0.0, 1
+                                 } );
+      all += seconds[s];
+    }
+  metrics.push_back ( Metric {"ticks/sec", all > 0 ? schedule[2] / all : 0.0, 1} );
+  metrics.push_back ( Metric {"searching ticks", ( double ) searching, -1} );
+  metrics.push_back ( Metric {"searches", ( double ) searches, 0} );
+  metrics.push_back ( Metric {"longest search", ( double ) longest, -1} );
+  metrics.push_back ( Metric {"MPUs", ( double ) gameOfLife.nofMPUs(), 0} );
+  metrics.push_back ( Metric {"peak RSS MB", peak_rss_mb(), -1} );
+  if ( SamuAlloc::counting() )
+    {
+      metrics.push_back ( Metric {"allocs/tick", ( double ) allocs.total() / schedule[2], -1} );
+      metrics.push_back ( Metric {"steady ticks", ( double ) steady, 0} );
+      metrics.push_back ( Metric {"steady allocs/tick", steady ? ( double ) steady_allocs.total() / steady : 0.0, -1} );
+
+      std::fprintf ( stderr, "the allocations of a steady-state tick\n" );
+      SamuAlloc::dump ( steady_allocs, std::cerr, steady ? steady : 1 );
+    }
+
+  if ( write_path )
+    {
+      std::ofstream out ( write_path );
+      write_metrics ( metrics, out, "" );
+      out << '\n';
+    }
+
+  std::ostringstream json;
+  json << "{\n  \"bench\": \"ScenarioBench\",\n"
+       << "  \"lattice\": \"" << w << 'x' << h << "\",\n"
+       << "  \"threads\": " << omp_get_max_threads() << ",\n"
+       << "  \"metrics\": ";
+  write_metrics ( metrics, json, "  " );
+  json << ",\n  \"regressions\": [";
+
+  int regressions {0};
+  for ( const Metric & metric : metrics )
+    for ( const Metric & base : baseline )
+      if ( base.name == metric.name )
+        {
+          double change = base.value != 0.0 ? ( metric.value - base.value ) / std::fabs ( base.value )
+                          : ( metric.value != 0.0 ? 1.0 : 0.0 );
+
+          bool regression = metric.better ? -metric.better * change > threshold
+                            : std::fabs ( change ) > threshold;
+          if ( regression )
+            {
+              std::fprintf ( stderr, "REGRESSION %s: %g (baseline %g, %+.1f%%)\n",
+                             metric.name.c_str(), metric.value, base.value, 100.0 * change );
+
+              json << ( regressions++ ? ", " : "" ) << '"' << metric.name << '"';
+            }
+        }
+
+  json << "]\n}\n";
+  std::fputs ( json.str().c_str(), stdout );
+
+  if ( assert_no_alloc && steady_allocs.total() )
+    {
+      std::fprintf ( stderr, "ALLOCATION in the steady state: %llu allocations in %ld ticks, first at tick %ld\n",
+                     ( unsigned long long ) steady_allocs.total(), steady, first_alloc );
+      return 2;
+    }
+
+  return regressions ? 1 : 0;
+}
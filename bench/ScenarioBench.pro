@@ -0,0 +1,7 @@
+# The Conway, Stroop and Movie scenarios end to end, against a baseline
+include(core.pri)
+
+TARGET = ScenarioBench
+# the baseline in the repo, also for shadow builds
+DEFINES += SCENARIO_BASELINE=\\\"$$PWD/scenario_baseline.json\\\"
+SOURCES += ScenarioBench.cpp
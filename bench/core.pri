@@ -0,0 +1,12 @@
+# The core compiled into a benchmark, so the layout of QL is the one of
+# the including project.
+
+include(../SamuBrain.pri)
+
+TEMPLATE = app
+QT =
+CONFIG += console
+CONFIG -= app_bundle
+
+HEADERS += ../SamuRing.h ../SamuLog.h ../SamuProf.h ../SamuAlloc.h ../SamuTrace.h ../SamuSnapshot.h ../SamuJournal.h ../SamuSource.h ../SamuFrames.h ../SamuTimeline.h ../SamuSprite.h ../SamuWorld.h ../SamuNeighbourhood.h ../SamuQl.h ../SamuBrain.h ../GameOfLife.h
+SOURCES += ../SamuLog.cpp ../SamuProf.cpp ../SamuAlloc.cpp ../SamuTrace.cpp ../SamuSnapshot.cpp ../SamuJournal.cpp ../SamuSource.cpp ../SamuFrames.cpp ../SamuTimeline.cpp ../SamuWorld.cpp ../SamuNeighbourhood.cpp ../SamuBrain.cpp ../GameOfLife.cpp
@@ -0,0 +1,6 @@
+# The micro-benchmarks of the hot kernels (KernelBench.cpp).
+
+include(core.pri)
+
+SOURCES += KernelBench.cpp
+HEADERS += SamuPerf.h
@@ -0,0 +1,11 @@
+# The simulation and the learning without Qt
+
+include(../SamuBrain.pri)
+
+TEMPLATE = lib
+TARGET = samubrain
+QT =
+CONFIG += staticlib
+
+HEADERS += ../SamuRing.h ../SamuLog.h ../SamuProf.h ../SamuAlloc.h ../SamuTrace.h ../SamuSnapshot.h ../SamuJournal.h ../SamuSource.h ../SamuFrames.h ../SamuTimeline.h ../SamuSprite.h ../SamuWorld.h ../SamuNeighbourhood.h ../SamuQl.h ../SamuBrain.h ../GameOfLife.h
+SOURCES += ../SamuLog.cpp ../SamuProf.cpp ../SamuAlloc.cpp ../SamuTrace.cpp ../SamuSnapshot.cpp ../SamuJournal.cpp ../SamuSource.cpp ../SamuFrames.cpp ../SamuTimeline.cpp ../SamuWorld.cpp ../SamuNeighbourhood.cpp ../SamuBrain.cpp ../GameOfLife.cpp
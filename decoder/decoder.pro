@@ -0,0 +1,12 @@
+include(../SamuBrain.pri)
+
+TEMPLATE = app
+TARGET = SamuLogDecode
+QT =
+CONFIG += console
+CONFIG -= app_bundle
+
+LIBS += -L$$OUT_PWD/../core -lsamubrain
+PRE_TARGETDEPS += $$OUT_PWD/../core/libsamubrain.a
+
+SOURCES += main.cpp
@@ -0,0 +1,65 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file main.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The offline decoder of the monitor records (SamuBrainHeadless --log):
+ * it writes the same text as the monitors write on the standard error.
+ *
+ * SamuLogDecode monitors.log | grep "HIGHER-ORDER NOTION MONITOR"
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "SamuLog.h"
+
+int main ( int argc, char** argv )
+{
+  if ( argc < 2 )
+    {
+      std::fprintf ( stderr, "Usage: %s file...\n", argv[0] );
+      return 1;
+    }
+
+  for ( int i {1}; i<argc; ++i )
+    {
+      std::ifstream in ( argv[i], std::ios::binary );
+
+      if ( !SamuLog::read_header ( in ) )
+        {
+          std::fprintf ( stderr, "%s is not a SamuLog file.\n", argv[i] );
+          return 1;
+        }
+
+      SamuRecord record;
+
+      while ( in.read ( reinterpret_cast<char *> ( &record ), sizeof ( record ) ) )
+        {
+          SamuLog::decode ( record, std::cout );
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file GameOfLifeThread.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The GUI runs the Qt-free GameOfLife in its own thread.
+ */
+
+#include "GameOfLifeThread.h"
+
+GameOfLifeThread::GameOfLifeThread ( int w, int h ) : m_gameOfLife ( w, h )
+{
+}
+
+void GameOfLifeThread::run()
+{
+
+  while ( true )
+    {
+      QThread::msleep ( m_delay );
+
+      if ( !paused )
+        {
+          m_gameOfLife.step();
+
+          SAMU_PHASE ( EMIT );
+          emit cellsChanged ( m_gameOfLife.lattice(), m_gameOfLife.getPredictions(),
+                              m_gameOfLife.getFp(), m_gameOfLife.getFr() );
+        }
+    }
+
+}
+
+void GameOfLifeThread::pause()
+{
+  paused = !paused;
+}
@@ -0,0 +1,75 @@
+#ifndef GameOfLifeThread_H
+#define GameOfLifeThread_H
+
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file GameOfLifeThread.h
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * The GUI runs the Qt-free GameOfLife in its own thread: it steps it
+ * with a delay (that can be changed and paused) and it signals the
+ * changed lattices to the window.
+ */
+
+#include <QThread>
+#include "GameOfLife.h"
+
+class GameOfLifeThread : public QThread
+{
+    Q_OBJECT
+
+    GameOfLife m_gameOfLife;
+
+    int m_delay {1};//{15};
+    bool paused {false};
+
+public:
+    GameOfLifeThread ( int w = 30, int h = 20 );
+
+    void run();
+    void pause();
+    int getW() const {
+        return m_gameOfLife.getW();
+    }
+    int getH() const {
+        return m_gameOfLife.getH();
+    }
+    long getT() const {
+        return m_gameOfLife.getT();
+    }
+    int getDelay() const {
+        return m_delay;
+    }
+    void setDelay ( int delay ) {
+        if ( delay > 0 ) {
+            m_delay = delay;
+        }
+    }
+
+signals:
+    void cellsChanged ( int **, int **, int **, int ** );
+
+};
+
+#endif // GameOfLifeThread_H
@@ -49,6 +49,7 @@
  */
 
 
+#include <iostream>
 #include "SamuLife.h"
 
 SamuLife::SamuLife ( int w, int h, QWidget *parent ) : QMainWindow ( parent )
@@ -56,7 +57,7 @@ SamuLife::SamuLife ( int w, int h, QWidget *parent ) : QMainWindow ( parent )
   setWindowTitle ( "SamuBrain, exp. 4, cognitive mental organs: MPU (Mental Processing Unit), COP-based Q-learning, acquiring higher-order knowledge" );
   setFixedSize ( QSize ( 2*w*m_cw, 2*h*m_ch ) );
 
-  gameOfLife = new GameOfLife ( w, h );
+  gameOfLife = new GameOfLifeThread ( w, h );
   gameOfLife->start();
 
   connect ( gameOfLife, SIGNAL ( cellsChanged ( int **, int **, int **, int ** ) ),
@@ -75,6 +76,8 @@ void SamuLife::updateCells ( int **lattice, int **prediction, int **fp, int** fr
 
 void SamuLife::paintEvent ( QPaintEvent* )
 {
+  SAMU_PHASE ( PAINT );
+
   QPainter qpainter ( this );
 
   for ( int i {0}; i<gameOfLife->getH(); ++i )
@@ -192,6 +195,10 @@ void SamuLife::keyPressEvent ( QKeyEvent * event )
     {
       gameOfLife->setDelay ( gameOfLife->getDelay() * 2.0 );
     }
+  else if ( event->key() == Qt::Key_P )
+    {
+      SamuProf::dump ( std::cerr );
+    }
 }
 
 SamuLife::~SamuLife()
@@ -56,14 +56,14 @@
 #include <QMainWindow>
 #include <QPainter>
 #include <QFont>
-#include "GameOfLife.h"
+#include "GameOfLifeThread.h"
 
 class SamuLife : public QMainWindow
 {
     Q_OBJECT
 
     int m_cw {12*2}, m_ch {10*2};
-    GameOfLife *gameOfLife;
+    GameOfLifeThread *gameOfLife;
     int **lattice {nullptr};
     int **prediction {nullptr};
     int **fp {nullptr};
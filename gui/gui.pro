@@ -0,0 +1,17 @@
+# The Qt GUI, a client of the core library
+
+include(../SamuBrain.pri)
+
+QT += widgets core
+
+TEMPLATE = app
+TARGET = SamuBrain
+DESTDIR = ..
+INCLUDEPATH += .
+
+LIBS += -L$$OUT_PWD/../core -lsamubrain
+PRE_TARGETDEPS += $$OUT_PWD/../core/libsamubrain.a
+
+# Input
+HEADERS += SamuLife.h GameOfLifeThread.h
+SOURCES += main.cpp SamuLife.cpp GameOfLifeThread.cpp
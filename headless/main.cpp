@@ -0,0 +1,582 @@
+/**
+ * @brief Samu has learnt the rules of Conway's Game of Life
+ *
+ * @file main.cpp
+ * @author  Norbert Bátfai <nbatfai@gmail.com>
+ * @version 0.0.1
+ *
+ * @section LICENSE
+ *
+ * Copyright (C) 2015, 2016 Norbert Bátfai, batfai.norbert@inf.unideb.hu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * SamuBrain without GUI and without Qt: it drives GameOfLife and SamuBrain
+ * of the core library in a tight loop (no sleeping between the ticks) and
+ * reports the throughput at exit.
+ *
+ * SamuBrainHeadless [--width 34] [--height 16] [--ticks 22000]
+ *                   [--schedule 5000,13000,22000] [--threads n]
+ *                   [--verbose] [--log file] [--level 0-3] [--memory n]
+ *                   [--trace file] [--save file] [--restore file]
+ *                   [--journal file] [--compaction n]
+ *                   [--paging file] [--idle n]
+ *                   [--record file] [--replay file]
+ *                   [--input file|-] [--format pbm|raw]
+ *                   [--timeline file]
+ *                   [--world 4096x4096] [--seed n] [--soup p] [--gliders d]
+ *                   [--spaceships d] [--window x,y,w,h]
+ *                   [--neighbourhood moore|vonneumann] [--radius r] [--colors k]
+ *
+ * The options by groups:
+ *
+ * - the scenarios: --schedule gives the ends of the Conway, Stroop and
+ *   Movie scenarios.
+ * - the monitors (SamuLog): they are discarded unless --verbose (text on
+ *   the standard error) or --log (records for SamuLogDecode) is given.
+ *   --level sets the level of all the monitors, --memory writes the memory
+ *   of the MPUs (MEMORY MONITOR) in every n ticks and --trace writes a
+ *   timeline of the run in the Chrome trace event format (SamuTrace).
+ * - the snapshots (SamuBrain::save): --restore starts with the brain of a
+ *   snapshot, --save writes the brain into a snapshot at exit. --journal
+ *   keeps a base snapshot in file and the deltas since the base in
+ *   file.log, a new base is written in every n ticks of --compaction
+ *   (SamuJournal); if file exists, the brain is recovered from it first.
+ *   They are rejected in FEELINGS builds.
+ * - the paging (SamuBrain::setPaging): --paging pages the MPUs that have
+ *   not been current for n ticks of --idle out into file and writes the
+ *   residency at exit.
+ * - the sources of the frames: --record writes the reality of the ticks
+ *   into file, --replay learns the frames of a recording (repeated from the
+ *   first one) with the size of the recording (SamuFrames.h). --input
+ *   learns the frames of a stream (a file, a named pipe or - for the
+ *   standard input) until its end, in the PBM format (the size of the first
+ *   image) or in the raw format (a byte per cell, the size of --width and
+ *   --height), see SamuSource.h. --timeline replaces the schedule with the
+ *   scenario timeline of file, its segments marked skip are not learnt
+ *   (SamuTimeline.h).
+ * - the world (SamuWorld.h): --world learns a large torus of Conway's Game
+ *   of Life seeded from --seed with a random soup (the probability of a
+ *   live cell), gliders and spaceships (d in each 10000 cells). The learner
+ *   sees the window of --window (the whole world by default) and the time
+ *   of the generations is written at exit.
+ * - the neighbourhood (SamuNeighbourhood.h): --neighbourhood, --radius and
+ *   --colors set the neighbourhood and the colors counted in the keys of
+ *   the cells, Moore of radius 1 and 5 colors by default.
+ *
+ * Built with SAMU_PROFILE, it writes the timing of the phases at exit and
+ * on SIGUSR1. Built with SAMU_ALLOC, it writes the heap allocations of a
+ * tick per phase at exit.
+ */
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <omp.h>
+#include "GameOfLife.h"
+#include "SamuAlloc.h"
+#include "SamuWorld.h"
+
+volatile std::sig_atomic_t dump {0};
+
+void on_sigusr1 ( int )
+{
+  dump = 1;
+}
+
+void usage ( const char * name )
+{
+  std::fprintf ( stderr,
+                 "Usage: %s [--width w] [--height h] [--ticks n]"
+                 " [--schedule conway,stroop,movie] [--threads n]"
+                 " [--verbose] [--log file] [--level 0-3] [--memory n]"
+                 " [--trace file] [--save file] [--restore file]"
+                 " [--journal file] [--compaction n]"
+                 " [--paging file] [--idle n]"
+                 " [--record file] [--replay file]"
+                 " [--input file|-] [--format pbm|raw]"
+                 " [--timeline file]"
+                 " [--world wxh] [--seed n] [--soup p] [--gliders d]"
+                 " [--spaceships d] [--window x,y,w,h]"
+                 " [--neighbourhood moore|vonneumann] [--radius r] [--colors k]\n",
+                 name );
+}
+
+int main ( int argc, char** argv )
+{
+  int w {34}, h {16};
+  long ticks {22000};
+  long conway {5000}, stroop {13000}, movie {22000};
+  int threads {0};
+  bool verbose {false};
+  const char * log {nullptr};
+  int level {-1};
+  int memory {0};
+  const char * trace {nullptr};
+  const char * save {nullptr};
+  const char * restore {nullptr};
+  const char * journal {nullptr};
+  long compaction {1000};
+  const char * paging {nullptr};
+  int idle {1000};
+  const char * record {nullptr};
+  const char * replay {nullptr};
+  const char * input {nullptr};
+  SamuFormat format {SamuFormat::PBM};
+  const char * timeline {nullptr};
+  bool world {false};
+  SamuWorldConfig worldConfig;
+  SamuShape shape {SamuShape::MOORE};
+  int radius {1}, colors {5};
+
+  for ( int i {1}; i<argc; ++i )
+    {
+      bool has_value = i+1 < argc;
+
+      if ( !std::strcmp ( argv[i], "--width" ) && has_value )
+        {
+          w = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--height" ) && has_value )
+        {
+          h = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--ticks" ) && has_value )
+        {
+          ticks = std::atol ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--schedule" ) && has_value )
+        {
+          if ( std::sscanf ( argv[++i], "%ld,%ld,%ld", &conway, &stroop, &movie ) != 3
+               || ! ( conway <= stroop && stroop <= movie ) )
+            {
+              usage ( argv[0] );
+              return 1;
+            }
+        }
+      else if ( !std::strcmp ( argv[i], "--threads" ) && has_value )
+        {
+          threads = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--verbose" ) )
+        {
+          verbose = true;
+        }
+      else if ( !std::strcmp ( argv[i], "--log" ) && has_value )
+        {
+          log = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--level" ) && has_value )
+        {
+          level = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--memory" ) && has_value )
+        {
+          memory = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--trace" ) && has_value )
+        {
+          trace = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--save" ) && has_value )
+        {
+          save = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--restore" ) && has_value )
+        {
+          restore = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--journal" ) && has_value )
+        {
+          journal = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--compaction" ) && has_value )
+        {
+          compaction = std::atol ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--paging" ) && has_value )
+        {
+          paging = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--idle" ) && has_value )
+        {
+          idle = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--record" ) && has_value )
+        {
+          record = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--replay" ) && has_value )
+        {
+          replay = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--input" ) && has_value )
+        {
+          input = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--format" ) && has_value
+                && ( !std::strcmp ( argv[i+1], "pbm" ) || !std::strcmp ( argv[i+1], "raw" ) ) )
+        {
+          format = !std::strcmp ( argv[++i], "pbm" ) ? SamuFormat::PBM : SamuFormat::RAW;
+        }
+      else if ( !std::strcmp ( argv[i], "--timeline" ) && has_value )
+        {
+          timeline = argv[++i];
+        }
+      else if ( !std::strcmp ( argv[i], "--world" ) && has_value )
+        {
+          world = true;
+          if ( std::sscanf ( argv[++i], "%dx%d", &worldConfig.w, &worldConfig.h ) != 2 )
+            {
+              usage ( argv[0] );
+              return 1;
+            }
+        }
+      else if ( !std::strcmp ( argv[i], "--seed" ) && has_value )
+        {
+          worldConfig.seed = std::strtoul ( argv[++i], nullptr, 10 );
+        }
+      else if ( !std::strcmp ( argv[i], "--soup" ) && has_value )
+        {
+          worldConfig.soup = std::atof ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--gliders" ) && has_value )
+        {
+          worldConfig.gliders = std::atof ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--spaceships" ) && has_value )
+        {
+          worldConfig.spaceships = std::atof ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--neighbourhood" ) && has_value
+                && ( !std::strcmp ( argv[i+1], "moore" ) || !std::strcmp ( argv[i+1], "vonneumann" ) ) )
+        {
+          shape = !std::strcmp ( argv[++i], "moore" ) ? SamuShape::MOORE : SamuShape::VON_NEUMANN;
+        }
+      else if ( !std::strcmp ( argv[i], "--radius" ) && has_value )
+        {
+          radius = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--colors" ) && has_value )
+        {
+          colors = std::atoi ( argv[++i] );
+        }
+      else if ( !std::strcmp ( argv[i], "--window" ) && has_value )
+        {
+          if ( std::sscanf ( argv[++i], "%d,%d,%d,%d", &worldConfig.x, &worldConfig.y,
+                             &worldConfig.windowW, &worldConfig.windowH ) != 4 )
+            {
+              usage ( argv[0] );
+              return 1;
+            }
+        }
+      else
+        {
+          usage ( argv[0] );
+          return 1;
+        }
+    }
+
+#ifdef FEELINGS
+  if ( save || restore || journal )
+    {
+      std::fprintf ( stderr, "The snapshots are not supported with FEELINGS (the perceptrons of the feelings are not saved).\n" );
+      return 1;
+    }
+#endif
+
+  SamuTimeline scenarios;
+
+  if ( timeline && ( replay || input || !scenarios.load ( timeline ) ) )
+    {
+      std::fprintf ( stderr, "Cannot load %s: %s.\n", timeline,
+                     replay || input ? "the frames are not generated" : scenarios.error().c_str() );
+      return 1;
+    }
+
+  SamuReplay frames;
+
+  if ( replay )
+    {
+      if ( !frames.open ( replay ) )
+        {
+          std::fprintf ( stderr, "Cannot replay %s.\n", replay );
+          return 1;
+        }
+
+      w = frames.getW();
+      h = frames.getH();
+    }
+
+  SamuStream stream;
+
+  if ( input )
+    {
+      if ( replay || !stream.open ( input, format, w, h ) )
+        {
+          std::fprintf ( stderr, "Cannot read %s.\n", input );
+          return 1;
+        }
+
+      w = stream.getW();
+      h = stream.getH();
+    }
+
+  SamuWorld large;
+
+  if ( world )
+    {
+      if ( replay || input || timeline || !large.open ( worldConfig ) )
+        {
+          std::fprintf ( stderr, "Cannot create the world %dx%d.\n", worldConfig.w, worldConfig.h );
+          return 1;
+        }
+
+      w = large.getW();
+      h = large.getH();
+    }
+
+  // the sprites of the Stroop and Movie scenarios
+  if ( ( !replay && !input && !world && ( w < 31 || h < 12 ) ) || ticks < 0 )
+    {
+      std::fprintf ( stderr, "The lattice must be at least 31x12.\n" );
+      return 1;
+    }
+
+  if ( threads > 0 )
+    {
+      omp_set_num_threads ( threads );
+    }
+
+  if ( log && !SamuLog::open ( log ) )
+    {
+      std::fprintf ( stderr, "Cannot open %s.\n", log );
+      return 1;
+    }
+
+  if ( trace && !SamuTrace::open ( trace ) )
+    {
+      std::fprintf ( stderr, "Cannot open %s.\n", trace );
+      return 1;
+    }
+
+  if ( level >= 0 )
+    {
+      SamuLog::setLevel ( level );
+    }
+  else if ( !verbose && !log )
+    {
+      SamuLog::setLevel ( SamuLevel::OFF );
+    }
+
+  GameOfLife gameOfLife ( w, h );
+  gameOfLife.setSchedule ( conway, stroop, movie );
+  gameOfLife.getBrain()->setMemorySampling ( memory );
+
+  if ( !gameOfLife.getBrain()->setNeighbourhood ( SamuNeighbourhood ( shape, radius, colors ) ) )
+    {
+      std::fprintf ( stderr, "The radius must be 1..%d and the colors 1..%d.\n",
+                     SamuNeighbourhood::max_radius, SamuNeighbourhood::max_colors );
+      return 1;
+    }
+
+  SamuRecorder recorder;
+
+  if ( record )
+    {
+      if ( !recorder.open ( record, w, h ) )
+        {
+          std::fprintf ( stderr, "Cannot open %s.\n", record );
+          return 1;
+        }
+
+      gameOfLife.setRecorder ( &recorder );
+    }
+
+  if ( replay )
+    {
+      gameOfLife.setSource ( &frames );
+    }
+  else if ( input )
+    {
+      gameOfLife.setSource ( &stream );
+    }
+  else if ( world )
+    {
+      gameOfLife.setSource ( &large );
+    }
+  else if ( timeline )
+    {
+      gameOfLife.setTimeline ( &scenarios );
+    }
+
+  if ( restore )
+    {
+      auto begin = std::chrono::steady_clock::now();
+
+      if ( !gameOfLife.restore ( restore ) )
+        {
+          std::fprintf ( stderr, "Cannot restore %s.\n", restore );
+          return 1;
+        }
+
+      std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - begin;
+      std::fprintf ( stderr, "%s restored in %.1f ms, #MPUs: %d\n", restore, d.count(), gameOfLife.nofMPUs() );
+    }
+
+  if ( paging && !gameOfLife.getBrain()->setPaging ( paging, idle ) )
+    {
+      std::fprintf ( stderr, "Cannot open %s.\n", paging );
+      return 1;
+    }
+
+  if ( journal )
+    {
+      int width = gameOfLife.getBrain()->getNeighbourhood().width();
+
+      if ( width > static_cast<int> ( sizeof ( SamuDelta::key ) ) )
+        {
+          std::fprintf ( stderr, "The keys of the neighbourhood (%d characters) are too long for the journal (%zu).\n",
+                         width, sizeof ( SamuDelta::key ) );
+          return 1;
+        }
+
+      auto begin = std::chrono::steady_clock::now();
+
+      if ( std::ifstream ( journal ) )
+        {
+          if ( !SamuJournal::recover ( journal, *gameOfLife.getBrain() ) )
+            {
+              std::fprintf ( stderr, "Cannot recover %s.\n", journal );
+              return 1;
+            }
+
+          std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - begin;
+          std::fprintf ( stderr, "%s recovered in %.1f ms, #MPUs: %d\n", journal, d.count(), gameOfLife.nofMPUs() );
+        }
+
+      if ( !SamuJournal::open ( journal, *gameOfLife.getBrain(), compaction ) )
+        {
+          std::fprintf ( stderr, "Cannot open %s.\n", journal );
+          return 1;
+        }
+    }
+
+  std::signal ( SIGUSR1, on_sigusr1 );
+
+  SamuAllocs allocs = SamuAlloc::snapshot();
+  auto start = std::chrono::steady_clock::now();
+
+  for ( long t {0}; t<ticks; ++t )
+    {
+      if ( !gameOfLife.step() )
+        {
+          ticks = t;
+          break;
+        }
+
+      if ( dump )
+        {
+          dump = 0;
+          SamuProf::dump ( std::cerr );
+        }
+    }
+
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+
+  SamuTrace::close();
+  SamuJournal::close();
+
+  if ( SamuJournal::dropped() )
+    {
+      std::fprintf ( stderr, "%llu deltas have been lost (too long keys).\n",
+                     static_cast<unsigned long long> ( SamuJournal::dropped() ) );
+    }
+
+  if ( input )
+    {
+      std::fprintf ( stderr, "%s: %ld frames, the learner waited %llu times, the reader %llu times\n",
+                     input, ticks,
+                     static_cast<unsigned long long> ( stream.underruns() ),
+                     static_cast<unsigned long long> ( stream.stalls() ) );
+
+      if ( !stream.ok() )
+        {
+          std::fprintf ( stderr, "%s: a bad frame after %ld frames.\n", input, ticks );
+          return 1;
+        }
+    }
+
+  if ( world )
+    {
+      std::fprintf ( stderr, "world %dx%d (window %dx%d): %ld generations, %.2f ms per generation,"
+                     " population: %llu\n",
+                     large.getWorldW(), large.getWorldH(), large.getW(), large.getH(),
+                     large.tick(), large.tick() > 1 ? large.generationMs() / ( large.tick()-1 ) : 0.0,
+                     static_cast<unsigned long long> ( large.population() ) );
+    }
+
+  if ( record )
+    {
+      recorder.close();
+
+      if ( !recorder.ok() )
+        {
+          std::fprintf ( stderr, "Cannot record %s (the colors are 0..15).\n", record );
+          return 1;
+        }
+
+      std::fprintf ( stderr, "%llu frames recorded in %llu bytes\n",
+                     static_cast<unsigned long long> ( recorder.frames() ),
+                     static_cast<unsigned long long> ( recorder.bytes() ) );
+    }
+
+  if ( save && !gameOfLife.save ( save ) )
+    {
+      std::fprintf ( stderr, "Cannot save %s.\n", save );
+      return 1;
+    }
+
+  if ( SamuAlloc::counting() && ticks > 0 )
+    {
+      std::cerr << "the allocations of a tick\n";
+      SamuAlloc::dump ( SamuAlloc::snapshot() - allocs, std::cerr, ticks );
+    }
+
+  if ( paging )
+    {
+      SamuResidency r = gameOfLife.getBrain()->residency();
+
+      std::fprintf ( stderr, "MPUs resident: %d, paged out: %d (frozen tables: %zu bytes),"
+                     " page-outs: %llu, faults: %llu (%.1f ms), store: %llu of %llu bytes live\n",
+                     r.resident, r.paged, r.frozenBytes,
+                     static_cast<unsigned long long> ( r.pageOuts ),
+                     static_cast<unsigned long long> ( r.faults ), r.faultMs,
+                     static_cast<unsigned long long> ( r.storeLive ),
+                     static_cast<unsigned long long> ( r.storeBytes ) );
+    }
+
+  std::printf ( "lattice %dx%d, %d threads, %ld ticks in %.3f s, %.1f ticks/sec, #MPUs: %d\n",
+                w, h, omp_get_max_threads(), ticks, d.count(),
+                d.count() > 0 ? ticks / d.count() : 0.0,
+                gameOfLife.nofMPUs() );
+
+  return 0;
+}